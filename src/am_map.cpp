@@ -1782,12 +1782,12 @@ void DAutomap::drawGrid (int color)
 
 	// Figure out start of vertical gridlines
 	start = minx - extx;
-	start = ceil((start - bmaporgx) / FBlockmap::MAPBLOCKUNITS) * FBlockmap::MAPBLOCKUNITS + bmaporgx;
+	start = ceil((start - bmaporgx) / Level->blockmap.blockunits) * Level->blockmap.blockunits + bmaporgx;
 
 	end = minx + minlen - extx;
 
 	// draw vertical gridlines
-	for (x = start; x < end; x += FBlockmap::MAPBLOCKUNITS)
+	for (x = start; x < end; x += Level->blockmap.blockunits)
 	{
 		ml.a.x = x;
 		ml.b.x = x;
@@ -1803,11 +1803,11 @@ void DAutomap::drawGrid (int color)
 
 	// Figure out start of horizontal gridlines
 	start = miny - exty;
-	start = ceil((start - bmaporgy) / FBlockmap::MAPBLOCKUNITS) * FBlockmap::MAPBLOCKUNITS + bmaporgy;
+	start = ceil((start - bmaporgy) / Level->blockmap.blockunits) * Level->blockmap.blockunits + bmaporgy;
 	end = miny + minlen - exty;
 
 	// draw horizontal gridlines
-	for (y=start; y<end; y+=FBlockmap::MAPBLOCKUNITS)
+	for (y=start; y<end; y+=Level->blockmap.blockunits)
 	{
 		ml.a.x = minx - extx;
 		ml.b.x = ml.a.x + minlen;
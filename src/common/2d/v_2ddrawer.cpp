@@ -42,13 +42,20 @@
 #include "v_video.h"
 #include "fcolormap.h"
 #include "texturemanager.h"
+#include "stats.h"
 
 static F2DDrawer drawer = F2DDrawer();
 F2DDrawer* twod = &drawer;
 
+static struct
+{
+	int commandsadded, commandsmerged, commands, quads, vertices, indices;
+} Last2DFrame;
+
 EXTERN_CVAR(Float, transsouls)
 CVAR(Float, classic_scaling_factor, 1.0, CVAR_ARCHIVE)
 CVAR(Float, classic_scaling_pixelaspect, 1.2f, CVAR_ARCHIVE)
+CVAR(Bool, ui_textureatlas, true, CVAR_ARCHIVE)
 
 IMPLEMENT_CLASS(FCanvas, false, false)
 
@@ -222,9 +229,11 @@ DEFINE_ACTION_FUNCTION_NATIVE(DShape2D, PushTriangle, Shape2D_PushTriangle)
 int F2DDrawer::AddCommand(RenderCommand *data) 
 {
 	data->mScreenFade = screenFade;
+	mCommandsAdded++;
 	if (mData.Size() > 0 && data->isCompatible(mData.Last()))
 	{
 		// Merge with the last command.
+		mCommandsMerged++;
 		mData.Last().mIndexCount += data->mIndexCount;
 		mData.Last().mVertCount += data->mVertCount;
 		return mData.Size();
@@ -261,6 +270,55 @@ void F2DDrawer::AddIndices(int firstvert, TArray<int> &v)
 	}
 }
 
+//==========================================================================
+//
+// Reserves the space for a quad and returns the record the caller
+// needs to fill in. Nothing gets written to the buffers yet.
+//
+//==========================================================================
+
+F2DDrawer::TwoDQuad &F2DDrawer::AddQuad(RenderCommand &dg)
+{
+	dg.mVertCount = 4;
+	dg.mVertIndex = (int)mVertices.Reserve(4);
+	dg.mIndexIndex = (int)mIndices.Reserve(6);
+	dg.mIndexCount += 6;
+
+	auto &quad = mQuads[mQuads.Reserve(1)];
+	quad.vertindex = dg.mVertIndex;
+	quad.indexindex = dg.mIndexIndex;
+	return quad;
+}
+
+//==========================================================================
+//
+// Writes out all pending quads in one go.
+//
+//==========================================================================
+
+void F2DDrawer::GenerateQuads()
+{
+	for (auto &quad : mQuads)
+	{
+		TwoDVertex *ptr = &mVertices[quad.vertindex];
+		ptr[0].Set(quad.x[0], quad.y[0], 0, quad.u1, quad.v1, quad.color);
+		ptr[1].Set(quad.x[1], quad.y[1], 0, quad.u1, quad.v2, quad.color);
+		ptr[2].Set(quad.x[2], quad.y[2], 0, quad.u2, quad.v1, quad.color);
+		ptr[3].Set(quad.x[3], quad.y[3], 0, quad.u2, quad.v2, quad.color);
+
+		int *index = &mIndices[quad.indexindex];
+		int v = quad.vertindex;
+		index[0] = v;
+		index[1] = v + 1;
+		index[2] = v + 2;
+		index[3] = v + 1;
+		index[4] = v + 3;
+		index[5] = v + 2;
+	}
+	mQuadsGenerated += mQuads.Size();
+	mQuads.Clear();
+}
+
 //==========================================================================
 //
 // SetStyle
@@ -419,6 +477,21 @@ void F2DDrawer::SetColorOverlay(PalEntry color, float alpha, PalEntry &vertexcol
 	// The real color gets multiplied into vertexcolor later.
 }
 
+//==========================================================================
+//
+// Converts texture coordinates of an atlas packed texture to its page
+//
+//==========================================================================
+
+static void RemapToAtlas(FGameTexture* img, double& u1, double& v1, double& u2, double& v2)
+{
+	auto& rect = img->GetAtlasRect();
+	u1 = rect.left + u1 * rect.width;
+	u2 = rect.left + u2 * rect.width;
+	v1 = rect.top + v1 * rect.height;
+	v2 = rect.top + v2 * rect.height;
+}
+
 //==========================================================================
 //
 // Draws a texture
@@ -443,6 +516,10 @@ void F2DDrawer::AddTexture(FGameTexture* img, DrawParms& parms)
 	if (img->isWarped()) dg.mFlags |= DTF_Wrap;
 	if (parms.indexed) dg.mFlags |= DTF_Indexed;
 
+	// Textures packed into an atlas are drawn from their page so that consecutive draws can be merged.
+	auto atlaspage = ui_textureatlas ? img->GetAtlasPage() : nullptr;
+	if (atlaspage) dg.mTexture = atlaspage;
+
 	dg.mTranslationId = 0;
 	SetStyle(img, parms, vertexcolor, dg);
 	if (parms.indexed)
@@ -492,17 +569,17 @@ void F2DDrawer::AddTexture(FGameTexture* img, DrawParms& parms)
 			u1 = float(u1 + parms.windowleft / parms.texwidth);
 			u2 = float(u2 - (parms.texwidth - wi) / parms.texwidth);
 		}
-		auto t = this->transform;
-		auto tCorners = {
-			(t * DVector3(x,     y,     1.0)).XY(),
-			(t * DVector3(x,     y + h, 1.0)).XY(),
-			(t * DVector3(x + w, y,     1.0)).XY(),
-			(t * DVector3(x + w, y + h, 1.0)).XY()
-		};
-		double minx = std::min_element(tCorners.begin(), tCorners.end(), [] (auto d0, auto d1) { return d0.X < d1.X; })->X;
-		double maxx = std::max_element(tCorners.begin(), tCorners.end(), [] (auto d0, auto d1) { return d0.X < d1.X; })->X;
-		double miny = std::min_element(tCorners.begin(), tCorners.end(), [] (auto d0, auto d1) { return d0.Y < d1.Y; })->Y;
-		double maxy = std::max_element(tCorners.begin(), tCorners.end(), [] (auto d0, auto d1) { return d0.Y < d1.Y; })->Y;
+		if (atlaspage) RemapToAtlas(img, u1, v1, u2, v2);
+		auto &t = this->transform;
+		double minx = DBL_MAX, miny = DBL_MAX, maxx = -DBL_MAX, maxy = -DBL_MAX;
+		for (int i = 0; i < 4; i++)
+		{
+			auto corner = (t * DVector3(i < 2 ? x : x + w, (i & 1) ? y + h : y, 1.0)).XY();
+			minx = min(minx, corner.X);
+			maxx = max(maxx, corner.X);
+			miny = min(miny, corner.Y);
+			maxy = max(maxy, corner.Y);
+		}
 
 		if (minx < (double)parms.lclip || miny < (double)parms.uclip || maxx >(double)parms.rclip || maxy >(double)parms.dclip)
 		{
@@ -517,13 +594,14 @@ void F2DDrawer::AddTexture(FGameTexture* img, DrawParms& parms)
 			memset(dg.mScissor, 0, sizeof(dg.mScissor));
 		}
 
-		dg.mVertCount = 4;
-		dg.mVertIndex = (int)mVertices.Reserve(4);
-		TwoDVertex* ptr = &mVertices[dg.mVertIndex];
-		ptr->Set(x, y, 0, u1, v1, vertexcolor); ptr++;
-		ptr->Set(x, y + h, 0, u1, v2, vertexcolor); ptr++;
-		ptr->Set(x + w, y, 0, u2, v1, vertexcolor); ptr++;
-		ptr->Set(x + w, y + h, 0, u2, v2, vertexcolor); ptr++;
+		auto &quad = AddQuad(dg);
+		quad.x[0] = quad.x[1] = float(x);
+		quad.x[2] = quad.x[3] = float(x + w);
+		quad.y[0] = quad.y[2] = float(y);
+		quad.y[1] = quad.y[3] = float(y + h);
+		quad.u1 = float(u1); quad.v1 = float(v1);
+		quad.u2 = float(u2); quad.v2 = float(v2);
+		quad.color = vertexcolor;
 	}
 	else
 	{
@@ -547,28 +625,27 @@ void F2DDrawer::AddTexture(FGameTexture* img, DrawParms& parms)
 		double x4 = parms.x + xscale * (xd2 * cosang + yd2 * sinang);
 		double y4 = parms.y - yscale * (xd2 * sinang - yd2 * cosang);
 
+		if (atlaspage) RemapToAtlas(img, u1, v1, u2, v2);
+
 		dg.mScissor[0] = parms.lclip + int(offset.X);
 		dg.mScissor[1] = parms.uclip + int(offset.Y);
 		dg.mScissor[2] = parms.rclip + int(offset.X);
 		dg.mScissor[3] = parms.dclip + int(offset.Y);
 		dg.mFlags |= DTF_Scissor;
 
-		dg.mVertCount = 4;
-		dg.mVertIndex = (int)mVertices.Reserve(4);
-		TwoDVertex* ptr = &mVertices[dg.mVertIndex];
-		ptr->Set(x1, y1, 0, u1, v1, vertexcolor); ptr++;
-		ptr->Set(x2, y2, 0, u1, v2, vertexcolor); ptr++;
-		ptr->Set(x3, y3, 0, u2, v1, vertexcolor); ptr++;
-		ptr->Set(x4, y4, 0, u2, v2, vertexcolor); ptr++;
-
+		auto &quad = AddQuad(dg);
+		quad.x[0] = float(x1); quad.y[0] = float(y1);
+		quad.x[1] = float(x2); quad.y[1] = float(y2);
+		quad.x[2] = float(x3); quad.y[2] = float(y3);
+		quad.x[3] = float(x4); quad.y[3] = float(y4);
+		quad.u1 = float(u1); quad.v1 = float(v1);
+		quad.u2 = float(u2); quad.v2 = float(v2);
+		quad.color = vertexcolor;
 	}
 	dg.useTransform = true;
 	dg.transform = this->transform;
 	dg.transform.Cells[0][2] += offset.X;
 	dg.transform.Cells[1][2] += offset.Y;
-	dg.mIndexIndex = mIndices.Size();
-	dg.mIndexCount += 6;
-	AddIndices(dg.mVertIndex, 6, 0, 1, 2, 1, 3, 2);
 	AddCommand(&dg);
 	offset = osave;
 }
@@ -1004,21 +1081,18 @@ void F2DDrawer::AddColorOnlyQuad(int x1, int y1, int w, int h, PalEntry color, F
 	RenderCommand dg;
 
 	dg.mType = DrawTypeTriangles;
-	dg.mVertCount = 4;
-	dg.mVertIndex = (int)mVertices.Reserve(4);
 	dg.mRenderStyle = style? *style : LegacyRenderStyles[STYLE_Translucent];
-	auto ptr = &mVertices[dg.mVertIndex];
-	ptr->Set(x1, y1, 0, 0, 0, color); ptr++;
-	ptr->Set(x1, y1 + h, 0, 0, 0, color); ptr++;
-	ptr->Set(x1 + w, y1, 0, 0, 0, color); ptr++;
-	ptr->Set(x1 + w, y1 + h, 0, 0, 0, color); ptr++;
+	auto &quad = AddQuad(dg);
+	quad.x[0] = quad.x[1] = float(x1);
+	quad.x[2] = quad.x[3] = float(x1 + w);
+	quad.y[0] = quad.y[2] = float(y1);
+	quad.y[1] = quad.y[3] = float(y1 + h);
+	quad.u1 = quad.v1 = quad.u2 = quad.v2 = 0;
+	quad.color = color;
 	dg.useTransform = true;
 	dg.transform = this->transform;
 	dg.transform.Cells[0][2] += offset.X;
 	dg.transform.Cells[1][2] += offset.Y;
-	dg.mIndexIndex = mIndices.Size();
-	dg.mIndexCount += 6;
-	AddIndices(dg.mVertIndex, 6, 0, 1, 2, 1, 3, 2);
 	if (!prepend) AddCommand(&dg);
 	else
 	{
@@ -1195,14 +1269,28 @@ void F2DDrawer::Clear()
 {
 	if (!locked)
 	{
+		if (this == twod)
+		{
+			Last2DFrame = { mCommandsAdded, mCommandsMerged, (int)mData.Size(), mQuadsGenerated, (int)mVertices.Size(), (int)mIndices.Size() };
+		}
 		mVertices.Clear();
 		mIndices.Clear();
 		mData.Clear();
+		mQuads.Clear();
+		mCommandsAdded = mCommandsMerged = mQuadsGenerated = 0;
 		mIsFirstPass = true;
 	}
 	screenFade = 1.f;
 }
 
+ADD_STAT(2d)
+{
+	FString out;
+	out.Format("Last frame: %d commands submitted, %d merged, %d drawn - %d quads, %d vertices, %d indices",
+		Last2DFrame.commandsadded, Last2DFrame.commandsmerged, Last2DFrame.commands, Last2DFrame.quads, Last2DFrame.vertices, Last2DFrame.indices);
+	return out;
+}
+
 //==========================================================================
 //
 //
@@ -188,9 +188,22 @@ public:
 		}
 	};
 
+	// Textured and color quads only record their corners when submitted. The vertices
+	// and indices get written in one pass by GenerateQuads before the list is drawn.
+	struct TwoDQuad
+	{
+		float x[4], y[4];	// in vertex order: top left, bottom left, top right, bottom right
+		float u1, v1, u2, v2;
+		PalEntry color;
+		int vertindex;
+		int indexindex;
+	};
+
 	TArray<int> mIndices;
 	TArray<TwoDVertex> mVertices;
 	TArray<RenderCommand> mData;
+	TArray<TwoDQuad> mQuads;
+	int mCommandsAdded = 0, mCommandsMerged = 0, mQuadsGenerated = 0;
 	int Width, Height;
 	bool isIn2D;
 	bool locked;	// prevents clearing of the data so it can be reused multiple times (useful for screen fades)
@@ -203,8 +216,10 @@ public:
 
 	int AddCommand(RenderCommand *data);
 	void AddIndices(int firstvert, int count, ...);
+	void GenerateQuads();
 private:
 	void AddIndices(int firstvert, TArray<int> &v);
+	TwoDQuad &AddQuad(RenderCommand &dg);
 	bool SetStyle(FGameTexture *tex, DrawParms &parms, PalEntry &color0, RenderCommand &quad);
 	void SetColorOverlay(PalEntry color, float alpha, PalEntry &vertexcolor, PalEntry &overlaycolor);
 
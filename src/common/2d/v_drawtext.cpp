@@ -36,6 +36,7 @@
 #include <stdarg.h>
 #include <ctype.h>
 #include <wctype.h>
+#include <type_traits>
 
 #include "v_text.h"
 #include "utf8.h"
@@ -43,6 +44,8 @@
 #include "gstrings.h"
 #include "vm.h"
 #include "printf.h"
+#include "c_cvars.h"
+#include "stats.h"
 
 
 int ListGetInt(VMVa_List &tags);
@@ -260,51 +263,85 @@ DEFINE_ACTION_FUNCTION(FCanvas, DrawChar)
 //
 //==========================================================================
 
+CVAR(Bool, ui_textlayoutcache, true, 0)
+
 // This is only needed as a dummy. The code using wide strings does not need color control.
 EColorRange V_ParseFontColor(const char32_t *&color_value, int normalcolor, int boldcolor) { return CR_UNTRANSLATED; }
 
-template<class chartype>
-void DrawTextCommon(F2DDrawer *drawer, FFont *font, int normalcolor, double x, double y, const chartype *string, DrawParms &parms)
+//==========================================================================
+//
+// Text layout cache
+//
+// Most strings on screen, like HUD counters, menu items and console lines,
+// are the same every frame. Their glyph lookups, color escapes and advance
+// calculations only depend on the font, the string and a few of the draw
+// parameters, so the resulting glyph list is kept and only needs to be
+// positioned and handed to the 2D drawer again.
+//
+//==========================================================================
+
+struct FGlyphQuad
 {
-	int 		w;
-	const chartype *ch;
-	int 		c;
-	double 		cx;
-	double 		cy;
-	int			boldcolor;
-	int			trans = -1;
-	int			kerning;
 	FGameTexture *pic;
+	int trans;
+	PalEntry color;		// font color, still needs to be combined with DTA_Color
+	double x, y;		// relative to the string's origin
+	int w;
+};
 
-	double scalex = parms.scalex * parms.patchscalex;
-	double scaley = parms.scaley * parms.patchscaley;
+struct FTextLayout
+{
+	FFont *font;
+	int normalcolor;
+	bool palettetrans;
+	double scalex;
+	int cellx;
+	int celly;
+	int monospace;
+	int spacing;
+	int maxstrlen;
+	FString text;
+	TArray<FGlyphQuad> glyphs;
+};
+
+enum
+{
+	MAX_CACHED_LAYOUTS = 1024,
+	MAX_CACHED_TEXTLEN = 1024,
+};
 
-	if (parms.celly == 0) parms.celly = font->GetHeight() + 1;
-	parms.celly = int (parms.celly * scaley);
+static TMap<uint64_t, FTextLayout> TextLayouts;
+static int TextLayoutHits, TextLayoutMisses;
 
-	bool palettetrans = (normalcolor == CR_NATIVEPAL && parms.TranslationId != 0);
+void V_ClearTextLayoutCache()
+{
+	TextLayouts.Clear();
+}
 
-	if (normalcolor >= NumTextColors)
-		normalcolor = CR_UNTRANSLATED;
-	boldcolor = normalcolor ? normalcolor - 1 : NumTextColors - 1;
+//==========================================================================
+//
+// Resolves a string's characters to glyphs, relative to (0,0)
+//
+//==========================================================================
 
-	PalEntry colorparm = parms.color;
+template<class chartype>
+static void LayoutText(TArray<FGlyphQuad> &glyphs, FFont *font, int normalcolor, bool palettetrans, const chartype *string, const DrawParms &parms, double scalex)
+{
+	const chartype *ch = string;
+	int w;
+	int c;
 	PalEntry color = 0xffffffff;
-	trans = palettetrans? -1 : font->GetColorTranslation((EColorRange)normalcolor, &color);
-	parms.color = PalEntry(colorparm.a, (color.r * colorparm.r) / 255, (color.g * colorparm.g) / 255, (color.b * colorparm.b) / 255);
-
-	kerning = font->GetDefaultKerning();
-
-	ch = string;
-	cx = x;
-	cy = y;
+	int trans = palettetrans ? -1 : font->GetColorTranslation((EColorRange)normalcolor, &color);
+	int boldcolor = normalcolor ? normalcolor - 1 : NumTextColors - 1;
+	int kerning = font->GetDefaultKerning();
+	double cx = 0;
+	double cy = 0;
 
 	if (parms.monospace == EMonospacing::CellCenter)
 		cx += parms.spacing / 2;
 	else if (parms.monospace == EMonospacing::CellRight)
 		cx += parms.spacing;
 
-
 	auto currentcolor = normalcolor;
 	while (ch - string < parms.maxstrlen)
 	{
@@ -318,7 +355,6 @@ void DrawTextCommon(F2DDrawer *drawer, FFont *font, int normalcolor, double x, d
 			if (newcolor != CR_UNDEFINED)
 			{
 				trans = font->GetColorTranslation(newcolor, &color);
-				parms.color = PalEntry(colorparm.a, (color.r * colorparm.r) / 255, (color.g * colorparm.g) / 255, (color.b * colorparm.b) / 255);
 				currentcolor = newcolor;
 			}
 			continue;
@@ -326,30 +362,16 @@ void DrawTextCommon(F2DDrawer *drawer, FFont *font, int normalcolor, double x, d
 
 		if (c == '\n')
 		{
-			cx = x;
+			cx = 0;
 			cy += parms.celly;
 			continue;
 		}
 
-		if (NULL != (pic = font->GetChar(c, currentcolor, &w)))
+		FGameTexture *pic = font->GetChar(c, currentcolor, &w);
+		if (pic != nullptr)
 		{
-			// if palette translation is used, font colors will be ignored.
-			if (!palettetrans) parms.TranslationId = trans;
-			SetTextureParms(drawer, &parms, pic, cx, cy);
-			if (parms.cellx)
-			{
-				w = parms.cellx;
-				parms.destwidth = parms.cellx;
-				parms.destheight = parms.celly;
-			}
-			if (parms.monospace == EMonospacing::CellLeft)
-				parms.left = 0;
-			else if (parms.monospace == EMonospacing::CellCenter)
-				parms.left = w / 2.;
-			else if (parms.monospace == EMonospacing::CellRight)
-				parms.left = w;
-
-			drawer->AddTexture(pic, parms);
+			if (parms.cellx) w = parms.cellx;
+			glyphs.Push({ pic, trans, color, cx, cy, w });
 		}
 		if (parms.monospace == EMonospacing::Off)
 		{
@@ -359,8 +381,131 @@ void DrawTextCommon(F2DDrawer *drawer, FFont *font, int normalcolor, double x, d
 		{
 			cx += (parms.spacing) * scalex;
 		}
+	}
+}
 
+//==========================================================================
+//
+// Returns the cached layout of a string, creating it if needed
+//
+//==========================================================================
+
+static const TArray<FGlyphQuad> *GetTextLayout(FFont *font, int normalcolor, bool palettetrans, const uint8_t *string, const DrawParms &parms, double scalex)
+{
+	// Only the bytes the layout loop can possibly read are part of the key.
+	size_t limit = min<size_t>(MAX_CACHED_TEXTLEN + 1, size_t(max(parms.maxstrlen, 0)) + 3);
+	size_t len = 0;
+	while (len < limit && string[len] != 0) len++;
+	if (len > MAX_CACHED_TEXTLEN) return nullptr;
+
+	uint64_t hash = 0xcbf29ce484222325ull;
+	auto add = [&](uint64_t value) { hash = (hash ^ value) * 0x100000001b3ull; };
+	uint64_t sx;
+	memcpy(&sx, &scalex, sizeof(sx));
+	add(uint64_t(uintptr_t(font)));
+	add(uint64_t(normalcolor) | (uint64_t(palettetrans) << 32));
+	add(sx);
+	add(uint64_t(uint32_t(parms.cellx)));
+	add(uint64_t(uint32_t(parms.celly)) | (uint64_t(uint32_t(parms.monospace)) << 32));
+	add(uint64_t(uint32_t(parms.spacing)) | (uint64_t(uint32_t(parms.maxstrlen)) << 32));
+	for (size_t i = 0; i < len; i++) add(string[i]);
+
+	auto layout = TextLayouts.CheckKey(hash);
+	if (layout != nullptr && layout->font == font && layout->normalcolor == normalcolor && layout->palettetrans == palettetrans &&
+		layout->scalex == scalex && layout->cellx == parms.cellx && layout->celly == parms.celly && layout->monospace == parms.monospace &&
+		layout->spacing == parms.spacing && layout->maxstrlen == parms.maxstrlen &&
+		layout->text.Len() == len && !memcmp(layout->text.GetChars(), string, len))
+	{
+		TextLayoutHits++;
+		return &layout->glyphs;
+	}
+
+	TextLayoutMisses++;
+	if (layout == nullptr && TextLayouts.CountUsed() >= MAX_CACHED_LAYOUTS)
+	{
+		TextLayouts.Clear();
+	}
+	layout = &TextLayouts[hash];
+	layout->font = font;
+	layout->normalcolor = normalcolor;
+	layout->palettetrans = palettetrans;
+	layout->scalex = scalex;
+	layout->cellx = parms.cellx;
+	layout->celly = parms.celly;
+	layout->monospace = parms.monospace;
+	layout->spacing = parms.spacing;
+	layout->maxstrlen = parms.maxstrlen;
+	layout->text = FString((const char *)string, len);
+	layout->glyphs.Clear();
+	LayoutText(layout->glyphs, font, normalcolor, palettetrans, string, parms, scalex);
+	return &layout->glyphs;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+template<class chartype>
+void DrawTextCommon(F2DDrawer *drawer, FFont *font, int normalcolor, double x, double y, const chartype *string, DrawParms &parms)
+{
+	static TArray<FGlyphQuad> scratch;
+
+	double scalex = parms.scalex * parms.patchscalex;
+	double scaley = parms.scaley * parms.patchscaley;
+
+	if (parms.celly == 0) parms.celly = font->GetHeight() + 1;
+	parms.celly = int (parms.celly * scaley);
+
+	bool palettetrans = (normalcolor == CR_NATIVEPAL && parms.TranslationId != 0);
+
+	if (normalcolor >= NumTextColors)
+		normalcolor = CR_UNTRANSLATED;
+
+	const TArray<FGlyphQuad> *glyphs = nullptr;
+	if constexpr (std::is_same_v<chartype, uint8_t>)
+	{
+		if (ui_textlayoutcache) glyphs = GetTextLayout(font, normalcolor, palettetrans, string, parms, scalex);
 	}
+	if (glyphs == nullptr)
+	{
+		scratch.Clear();
+		LayoutText(scratch, font, normalcolor, palettetrans, string, parms, scalex);
+		glyphs = &scratch;
+	}
+
+	PalEntry colorparm = parms.color;
+	for (auto &glyph : *glyphs)
+	{
+		int w = glyph.w;
+		parms.color = PalEntry(colorparm.a, (glyph.color.r * colorparm.r) / 255, (glyph.color.g * colorparm.g) / 255, (glyph.color.b * colorparm.b) / 255);
+		// if palette translation is used, font colors will be ignored.
+		if (!palettetrans) parms.TranslationId = glyph.trans;
+		SetTextureParms(drawer, &parms, glyph.pic, x + glyph.x, y + glyph.y);
+		if (parms.cellx)
+		{
+			w = parms.cellx;
+			parms.destwidth = parms.cellx;
+			parms.destheight = parms.celly;
+		}
+		if (parms.monospace == EMonospacing::CellLeft)
+			parms.left = 0;
+		else if (parms.monospace == EMonospacing::CellCenter)
+			parms.left = w / 2.;
+		else if (parms.monospace == EMonospacing::CellRight)
+			parms.left = w;
+
+		drawer->AddTexture(glyph.pic, parms);
+	}
+}
+
+ADD_STAT(textlayout)
+{
+	FString out;
+	out.Format("%d layouts cached, %d reused, %d laid out", TextLayouts.CountUsed(), TextLayoutHits, TextLayoutMisses);
+	TextLayoutHits = TextLayoutMisses = 0;
+	return out;
 }
 
 
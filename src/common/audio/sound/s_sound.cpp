@@ -49,6 +49,7 @@
 CVARD(Bool, snd_enabled, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "enables/disables sound effects")
 CVAR(Bool, i_soundinbackground, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 CVAR(Bool, i_pauseinbackground, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVARD(Int, snd_voicebudget, 32, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "maximum number of positioned sounds started per update (0 = unlimited)")
 
 int SoundEnabled()
 {
@@ -556,7 +557,16 @@ FSoundChan *SoundEngine::StartSound(int type, const void *source,
 	{
 		chan = NULL;
 	}
-	else 
+	else if (snd_voicebudget > 0 && attenuation > 0 && type != SOURCE_None && source != listener.ListenerObject && !(chanflags & (CHANF_UI | CHANF_FORCE)))
+	{
+		// Positioned world sounds only get queued here. UpdateSounds will start
+		// the most audible ones within the voice budget and drop the rest.
+		chan = GetChannel(NULL);
+		GSnd->MarkStartTime(chan, startTime);
+		chan->Rolloff = *rolloff;
+		chanflags |= CHANF_EVICTED | CHANF_PENDING;
+	}
+	else
 	{
 		int startflags = 0;
 		if (chanflags & CHANF_LOOP) startflags |= SNDF_LOOP;
@@ -645,10 +655,11 @@ FSoundChan *SoundEngine::StartSound(int type, const void *source,
 // S_RestartSound
 //
 // Attempts to restart looping sounds that were evicted from their channels.
+// Pending sounds already passed the limit checks in StartSound and skip them.
 //
 //==========================================================================
 
-void SoundEngine::RestartChannel(FSoundChan *chan)
+void SoundEngine::RestartChannel(FSoundChan *chan, bool checklimits)
 {
 	assert(chan->ChanFlags & CHANF_EVICTED);
 
@@ -656,7 +667,7 @@ void SoundEngine::RestartChannel(FSoundChan *chan)
 	sfxinfo_t *sfx = &S_sfx[chan->SoundID];
 
 	// If this is a singular sound, don't play it if it's already playing.
-	if (sfx->bSingular && CheckSingular(chan->SoundID))
+	if (checklimits && sfx->bSingular && CheckSingular(chan->SoundID))
 		return;
 
 	sfx = LoadSound(sfx);
@@ -688,7 +699,7 @@ void SoundEngine::RestartChannel(FSoundChan *chan)
 
 		// If this sound doesn't like playing near itself, don't play it if
 		// that's what would happen.
-		if (chan->NearLimit > 0 && CheckSoundLimit(&S_sfx[chan->SoundID], pos, chan->NearLimit, chan->LimitRange, 0, NULL, 0, chan->DistanceScale))
+		if (checklimits && chan->NearLimit > 0 && CheckSoundLimit(&S_sfx[chan->SoundID], pos, chan->NearLimit, chan->LimitRange, 0, NULL, 0, chan->DistanceScale))
 		{
 			return;
 		}
@@ -818,7 +829,8 @@ bool SoundEngine::CheckSingular(int sound_id)
 // Limits the number of nearby copies of a sound that can play near
 // each other. If there are NearLimit instances of this sound already
 // playing within sqrt(limit_range) (typically 256 units) of the new sound, the
-// new sound will not start.
+// new sound will not start. Sounds still waiting for the voice budget
+// count as playing.
 //
 // If an actor is specified, and it is already playing the same sound on
 // the same channel, this sound will not be limited. In this case, we're
@@ -837,7 +849,7 @@ bool SoundEngine::CheckSoundLimit(sfxinfo_t *sfx, const FVector3 &pos, int near_
 	for (chan = Channels, count = 0; chan != NULL && count < near_limit; chan = chan->NextChan)
 	{
 		if (chan->ChanFlags & CHANF_FORGETTABLE) continue;
-		if (!(chan->ChanFlags & CHANF_EVICTED) && &S_sfx[chan->SoundID] == sfx)
+		if ((chan->ChanFlags & (CHANF_EVICTED | CHANF_PENDING)) != CHANF_EVICTED && &S_sfx[chan->SoundID] == sfx)
 		{
 			FVector3 chanorigin;
 
@@ -1217,7 +1229,7 @@ void SoundEngine::RestoreEvictedChannel(FSoundChan *chan)
 		return;
 	}
 	RestoreEvictedChannel(chan->NextChan);
-	if (chan->ChanFlags & CHANF_EVICTED)
+	if ((chan->ChanFlags & (CHANF_EVICTED | CHANF_PENDING)) == CHANF_EVICTED)
 	{
 		RestartChannel(chan);
 		if (!(chan->ChanFlags & CHANF_LOOP))
@@ -1253,6 +1265,111 @@ void SoundEngine::RestoreEvictedChannels()
 	RestoreEvictedChannel(Channels);
 }
 
+//==========================================================================
+//
+// GetStartPriority
+//
+// Scores a pending sound by how audible it will be at the listener.
+// A score of 0 means it cannot be heard at all.
+//
+//==========================================================================
+
+float SoundEngine::GetStartPriority(FSoundChan *chan)
+{
+	FVector3 pos;
+
+	CalcPosVel(chan, &pos, nullptr);
+	if (!ValidatePosVel(chan, pos, FVector3(0, 0, 0)))
+	{
+		return 0;
+	}
+
+	float score = chan->Volume;
+	if (!(chan->ChanFlags & CHANF_AREA))
+	{
+		float dist = (pos - listener.position).Length();
+		score *= GetRolloff(&chan->Rolloff, dist * chan->DistanceScale);
+	}
+	// Looping sounds that miss the budget stay evicted and get restarted later,
+	// so one-shots win ties against them.
+	if (chan->ChanFlags & CHANF_LOOP)
+	{
+		score *= 0.75f;
+	}
+	return score;
+}
+
+//==========================================================================
+//
+// StartPendingChannels
+//
+// Starts the sounds queued since the last update. Only the snd_voicebudget
+// most audible ones get a real voice. Of the rest, one-shots are dropped
+// and loops are left evicted so RestoreEvictedChannels can pick them up.
+//
+//==========================================================================
+
+void SoundEngine::StartPendingChannels()
+{
+	PendingStarts.Clear();
+	for (FSoundChan *chan = Channels; chan != NULL; chan = chan->NextChan)
+	{
+		if (chan->ChanFlags & CHANF_PENDING)
+		{
+			PendingStarts.Push({ chan, GetStartPriority(chan) });
+		}
+	}
+	if (PendingStarts.Size() == 0)
+	{
+		return;
+	}
+
+	std::stable_sort(PendingStarts.begin(), PendingStarts.end(), [](const FPendingStart &a, const FPendingStart &b)
+	{
+		return a.Score > b.Score;
+	});
+
+	// Clear the flag up front so that the queued sounds do not count against each other's near limit.
+	for (auto &pending : PendingStarts)
+	{
+		pending.Chan->ChanFlags &= ~CHANF_PENDING;
+	}
+
+	int budget = snd_voicebudget;
+	int started = 0;
+	for (auto &pending : PendingStarts)
+	{
+		FSoundChan *chan = pending.Chan;
+		if ((budget <= 0 || started < budget) && pending.Score > 0)
+		{
+			RestartChannel(chan, false);
+		}
+		if (!(chan->ChanFlags & CHANF_EVICTED))
+		{
+			started++;
+		}
+		else if (!(chan->ChanFlags & CHANF_LOOP))
+		{
+			ReturnChannel(chan);
+		}
+	}
+	PendingStarted = started;
+	PendingDropped = PendingStarts.Size() - started;
+}
+
+//==========================================================================
+//
+// GetVoiceBudgetStats
+//
+//==========================================================================
+
+FString SoundEngine::GetVoiceBudgetStats()
+{
+	FString out;
+	out.Format("Voice budget %d: %d started, %d dropped", *snd_voicebudget, PendingStarted, PendingDropped);
+	return out;
+}
+
 //==========================================================================
 //
 // S_UpdateSounds
@@ -1264,6 +1381,8 @@ void SoundEngine::UpdateSounds(int time)
 {
 	FVector3 pos, vel;
 
+	StartPendingChannels();
+
 	for (FSoundChan* chan = Channels; chan != NULL; chan = chan->NextChan)
 	{
 		if ((chan->ChanFlags & (CHANF_EVICTED | CHANF_IS3D)) == CHANF_IS3D)
@@ -1864,4 +1983,9 @@ ADD_STAT(sound)
 	return GSnd->GatherStats();
 }
 
+ADD_STAT(voicebudget)
+{
+	return soundEngine->GetVoiceBudgetStats();
+}
+
 
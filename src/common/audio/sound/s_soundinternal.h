@@ -215,12 +215,24 @@ protected:
 	TArray<FRandomSoundList> S_rnd;
 	bool blockNewSounds = false;
 
+	// Sounds queued by StartSound, to be started in UpdateSounds in order of audibility.
+	struct FPendingStart
+	{
+		FSoundChan* Chan;
+		float Score;
+	};
+	TArray<FPendingStart> PendingStarts;
+	int PendingStarted = 0;
+	int PendingDropped = 0;
+
 private:
 	void LinkChannel(FSoundChan* chan, FSoundChan** head);
 	void UnlinkChannel(FSoundChan* chan);
 	void ReturnChannel(FSoundChan* chan);
-	void RestartChannel(FSoundChan* chan);
+	void RestartChannel(FSoundChan* chan, bool checklimits = true);
 	void RestoreEvictedChannel(FSoundChan* chan);
+	float GetStartPriority(FSoundChan* chan);
+	void StartPendingChannels();
 
 	bool IsChannelUsed(int sourcetype, const void* actor, int channel, int* seen);
 	// This is the actual sound positioning logic which needs to be provided by the client.
@@ -386,6 +398,7 @@ public:
 
 	void ChannelVirtualChanged(FISoundChannel* ichan, bool is_virtual);
 	FString ListSoundChannels();
+	FString GetVoiceBudgetStats();
 
 	// Allow this to be overridden for special needs.
 	virtual float GetRolloff(const FRolloffInfo* rolloff, float distance);
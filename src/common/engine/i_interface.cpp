@@ -4,6 +4,7 @@
 #include "startupinfo.h"
 #include "c_cvars.h"
 #include "gstrings.h"
+#include "v_font.h"
 
 static_assert(sizeof(void*) == 8, "32 builds are not supported");
 
@@ -32,6 +33,7 @@ EXTERN_CVAR(Bool, ui_generic)
 CUSTOM_CVAR(String, language, "auto", CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALCONFIG)
 {
 	GStrings.UpdateLanguage(self);
+	V_ClearTextLayoutCache();
 	UpdateGenericUI(ui_generic);
 	if (sysCallbacks.LanguageChanged) sysCallbacks.LanguageChanged(self);
 }
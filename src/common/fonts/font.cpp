@@ -55,6 +55,7 @@
 #include "fontchars.h"
 #include "multipatchtexture.h"
 #include "texturemanager.h"
+#include "textureatlas.h"
 #include "i_interface.h"
 
 #include "fontinternals.h"
@@ -789,6 +790,26 @@ int FFont::GetCharCode(int code, bool needpic) const
 	return -1;
 }
 
+//==========================================================================
+//
+// FFont :: BuildAtlas
+//
+// Packs the glyphs into shared pages so that text can be drawn without
+// switching textures for each character. Only the Latin range is packed,
+// for large Unicode fonts this would create lots of mostly unused pages.
+//
+//==========================================================================
+
+void FFont::BuildAtlas()
+{
+	FTextureAtlasBuilder builder;
+	for (int i = FirstChar; i <= LastChar && i < 0x250; i++)
+	{
+		builder.Add(Chars[i - FirstChar].OriginalPic);
+	}
+	builder.Build(ETextureType::FontChar);
+}
+
 //==========================================================================
 //
 // FFont :: GetChar
@@ -133,7 +133,11 @@ FFont *V_GetFont(const char *name, const char *fontlumpname)
 			{
 				FFont *CreateSingleLumpFont (const char *fontname, int lump);
 				font = CreateSingleLumpFont (name, lump);
-				if (translationsLoaded) font->LoadTranslations();
+				if (translationsLoaded)
+				{
+					font->LoadTranslations();
+					font->BuildAtlas();
+				}
 				return font;
 			}
 		}
@@ -151,7 +155,11 @@ FFont *V_GetFont(const char *name, const char *fontlumpname)
 		if (folderdata.Size() > 0)
 		{
 			font = new FFont(name, nullptr, name, 0, 0, 1, -1);
-			if (translationsLoaded) font->LoadTranslations();
+			if (translationsLoaded)
+			{
+				font->LoadTranslations();
+				font->BuildAtlas();
+			}
 			return font;
 		}
 	}
@@ -880,9 +888,11 @@ void V_InitFonts()
 
 void V_LoadTranslations()
 {
+	V_ClearTextLayoutCache();
 	for (auto font = FFont::FirstFont; font; font = font->Next)
 	{
 		if (!font->noTranslate) font->LoadTranslations();
+		font->BuildAtlas();
 	}
 
 	if (BigFont)
@@ -923,6 +933,7 @@ void V_LoadTranslations()
 
 void V_ClearFonts()
 {
+	V_ClearTextLayoutCache();
 	while (FFont::FirstFont != nullptr)
 	{
 		delete FFont::FirstFont;
@@ -113,6 +113,7 @@ public:
 	int GetMaxAscender(const char* text) const { return GetMaxAscender((uint8_t*)text); }
 	int GetMaxAscender(const FString &text) const { return GetMaxAscender((uint8_t*)text.GetChars()); }
 	virtual void LoadTranslations();
+	void BuildAtlas();
 	FName GetName() const { return FontName; }
 
 	static FFont *FindFont(FName fontname);
@@ -220,6 +221,7 @@ void V_InitFontColors();
 char* CleanseString(char* str);
 void V_ApplyLuminosityTranslation(int translation, uint8_t* pixel, int size);
 void V_LoadTranslations();
+void V_ClearTextLayoutCache();
 class FBitmap;
 
 
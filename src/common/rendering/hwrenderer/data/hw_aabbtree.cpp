@@ -26,31 +26,80 @@
 namespace hwrenderer
 {
 
-TArray<int> LevelAABBTree::FindNodePath(unsigned int line, unsigned int node)
+void LevelAABBTree::FinishTree()
 {
-	const AABBTreeNode &n = nodes[node];
+	parentNodes.Resize(nodes.Size());
+	for (auto &parent : parentNodes) parent = -1;
+	lineLeafs.Resize(treelines.Size());
 
-	if (n.aabb_left > treelines[line].x || n.aabb_right < treelines[line].x ||
-		n.aabb_top > treelines[line].y || n.aabb_bottom < treelines[line].y)
+	for (unsigned int i = 0; i < nodes.Size(); i++)
 	{
-		return {};
+		const auto &node = nodes[i];
+		if (node.line_index != -1)
+		{
+			lineLeafs[node.line_index] = i;
+		}
+		else
+		{
+			if (node.left_node != -1) parentNodes[node.left_node] = i;
+			if (node.right_node != -1) parentNodes[node.right_node] = i;
+		}
 	}
 
-	TArray<int> path;
+	flatNodes.Clear();
+	flatIndices.Resize(nodes.Size());
+	if (nodes.Size() > 0)
+		AddFlatNode(nodes.Size() - 1);
+}
+
+void LevelAABBTree::AddFlatNode(int node)
+{
+	const auto &n = nodes[node];
+	int index = flatNodes.Reserve(1);
+	flatIndices[node] = index;
+	flatNodes[index] = { n.aabb_left, n.aabb_top, n.aabb_right, n.aabb_bottom, 0, n.line_index };
+
 	if (n.line_index == -1)
 	{
-		path = FindNodePath(line, n.left_node);
-		if (path.Size() == 0)
-			path = FindNodePath(line, n.right_node);
-
-		if (path.Size())
-			path.Push(node);
+		if (n.left_node != -1) AddFlatNode(n.left_node);
+		if (n.right_node != -1) AddFlatNode(n.right_node);
 	}
-	else if (n.line_index == (int)line)
+	flatNodes[index].skip = flatNodes.Size();
+}
+
+void LevelAABBTree::RefitLine(unsigned int line, const AABBTreeLine &treeline)
+{
+	auto copyToFlat = [&](int nodeIndex)
 	{
-		path.Push(node);
+		const auto &node = nodes[nodeIndex];
+		auto &flat = flatNodes[flatIndices[nodeIndex]];
+		flat.aabb_left = node.aabb_left;
+		flat.aabb_top = node.aabb_top;
+		flat.aabb_right = node.aabb_right;
+		flat.aabb_bottom = node.aabb_bottom;
+	};
+
+	treelines[line] = treeline;
+
+	int nodeIndex = lineLeafs[line];
+	auto &leaf = nodes[nodeIndex];
+	leaf.aabb_left = std::min(treeline.x, treeline.x + treeline.dx);
+	leaf.aabb_right = std::max(treeline.x, treeline.x + treeline.dx);
+	leaf.aabb_top = std::min(treeline.y, treeline.y + treeline.dy);
+	leaf.aabb_bottom = std::max(treeline.y, treeline.y + treeline.dy);
+	copyToFlat(nodeIndex);
+
+	for (int parent = parentNodes[nodeIndex]; parent != -1; parent = parentNodes[parent])
+	{
+		auto &cur = nodes[parent];
+		const auto &left = nodes[cur.left_node];
+		const auto &right = nodes[cur.right_node];
+		cur.aabb_left = std::min(left.aabb_left, right.aabb_left);
+		cur.aabb_top = std::min(left.aabb_top, right.aabb_top);
+		cur.aabb_right = std::max(left.aabb_right, right.aabb_right);
+		cur.aabb_bottom = std::max(left.aabb_bottom, right.aabb_bottom);
+		copyToFlat(parent);
 	}
-	return path;
 }
 
 double LevelAABBTree::RayTest(const DVector3 &ray_start, const DVector3 &ray_end)
@@ -65,6 +114,123 @@ double LevelAABBTree::RayTest(const DVector3 &ray_start, const DVector3 &ray_end
 
 	double hit_fraction = 1.0;
 
+	// Walk the nodes in depth first order, skipping the subtrees the ray doesn't overlap
+	unsigned int node_index = 0;
+	unsigned int count = flatNodes.Size();
+	while (node_index < count)
+	{
+		const auto &node = flatNodes[node_index];
+		if (!OverlapRayAABB(ray_start, ray_end, node))
+		{
+			node_index = node.skip;
+		}
+		else
+		{
+			if (node.line_index != -1)
+			{
+				hit_fraction = std::min(IntersectRayLine(ray_start, ray_end, node.line_index, raydelta, rayd, raydist2), hit_fraction);
+			}
+			node_index++;
+		}
+	}
+
+	return hit_fraction;
+}
+
+void LevelAABBTree::RayTestPacket(const DVector3 *ray_start, const DVector3 *ray_end, int count, double *hit_fraction)
+{
+	// The node boxes get widened by this much to make up for the rounding errors of the single precision test.
+	// This can only cause extra line tests, which are done in double precision like in RayTest.
+	const float margin = 0.05f;
+
+	DVector2 starts[RayPacketSize], ends[RayPacketSize], raydelta[RayPacketSize];
+	double rayd[RayPacketSize], raydist2[RayPacketSize];
+	float cx[RayPacketSize], cy[RayPacketSize], wx[RayPacketSize], wy[RayPacketSize], vx[RayPacketSize], vy[RayPacketSize];
+	double hits[RayPacketSize];
+	int activemask = 0;
+
+	count = std::min<int>(count, RayPacketSize);
+	if (count <= 0)
+		return;
+
+	for (int l = 0; l < RayPacketSize; l++)
+	{
+		// Unused lanes repeat the first ray but never report anything.
+		int r = l < count ? l : 0;
+		starts[l] = ray_start[r].XY();
+		ends[l] = ray_end[r].XY();
+		raydelta[l] = ends[l] - starts[l];
+		raydist2[l] = raydelta[l] | raydelta[l];
+		rayd[l] = DVector2(raydelta[l].Y, -raydelta[l].X) | starts[l];
+		hits[l] = 1.0;
+		if (l < count && raydist2[l] >= 1.0)
+			activemask |= 1 << l;
+
+		DVector2 c = (starts[l] + ends[l]) * 0.5;
+		DVector2 w = ends[l] - c;
+		cx[l] = (float)c.X;
+		cy[l] = (float)c.Y;
+		wx[l] = (float)w.X;
+		wy[l] = (float)w.Y;
+		vx[l] = fabsf(wx[l]);
+		vy[l] = fabsf(wy[l]);
+	}
+
+	unsigned int node_index = 0;
+	unsigned int nodecount = activemask ? flatNodes.Size() : 0;
+	while (node_index < nodecount)
+	{
+		const auto &node = flatNodes[node_index];
+		float hx = (node.aabb_right - node.aabb_left) * 0.5f + margin;
+		float hy = (node.aabb_bottom - node.aabb_top) * 0.5f + margin;
+		float mx = (node.aabb_right + node.aabb_left) * 0.5f;
+		float my = (node.aabb_bottom + node.aabb_top) * 0.5f;
+
+		// Same separating axis test as OverlapRayAABB, for all lanes at once.
+		int overlap = 0;
+		for (int l = 0; l < RayPacketSize; l++)
+		{
+			float ox = cx[l] - mx;
+			float oy = cy[l] - my;
+			bool inside = (fabsf(ox) <= vx[l] + hx) & (fabsf(oy) <= vy[l] + hy) & (fabsf(ox * wy[l] - oy * wx[l]) <= hx * vy[l] + hy * vx[l]);
+			overlap |= int(inside) << l;
+		}
+		overlap &= activemask;
+
+		if (overlap == 0)
+		{
+			node_index = node.skip;
+		}
+		else
+		{
+			if (node.line_index != -1)
+			{
+				for (int l = 0; l < count; l++)
+				{
+					if (overlap & (1 << l))
+						hits[l] = std::min(IntersectRayLine(starts[l], ends[l], node.line_index, raydelta[l], rayd[l], raydist2[l]), hits[l]);
+				}
+			}
+			node_index++;
+		}
+	}
+
+	for (int l = 0; l < count; l++)
+		hit_fraction[l] = hits[l];
+}
+
+double LevelAABBTree::RayTestNodes(const DVector3 &ray_start, const DVector3 &ray_end)
+{
+	// Precalculate some of the variables used by the ray/line intersection test
+	DVector2 raydelta = ray_end - ray_start;
+	double raydist2 = raydelta | raydelta;
+	DVector2 raynormal = DVector2(raydelta.Y, -raydelta.X);
+	double rayd = raynormal | ray_start;
+	if (raydist2 < 1.0 || nodes.Size() == 0)
+		return 1.0f;
+
+	double hit_fraction = 1.0;
+
 	// Walk the tree nodes
 	int stack[32];
 	int stack_pos = 1;
@@ -131,6 +297,29 @@ bool LevelAABBTree::OverlapRayAABB(const DVector2 &ray_start2d, const DVector2 &
 	return true; // overlap;
 }
 
+bool LevelAABBTree::OverlapRayAABB(const DVector2 &ray_start, const DVector2 &ray_end, const AABBTreeFlatNode &node)
+{
+	// 2D version of the test above. With the ray at z = 0 all terms involving z drop out.
+	DVector2 aabb_min = DVector2(node.aabb_left, node.aabb_top);
+	DVector2 aabb_max = DVector2(node.aabb_right, node.aabb_bottom);
+
+	DVector2 c = (ray_start + ray_end) * 0.5f;
+	DVector2 w = ray_end - c;
+	DVector2 h = (aabb_max - aabb_min) * 0.5f; // aabb.extents();
+
+	c -= (aabb_max + aabb_min) * 0.5f; // aabb.center();
+
+	DVector2 v = DVector2(fabs(w.X), fabs(w.Y));
+
+	if (fabs(c.X) > v.X + h.X || fabs(c.Y) > v.Y + h.Y)
+		return false; // disjoint;
+
+	if (fabs(c.X * w.Y - c.Y * w.X) > h.X * v.Y + h.Y * v.X)
+		return false; // disjoint;
+
+	return true; // overlap;
+}
+
 double LevelAABBTree::IntersectRayLine(const DVector2 &ray_start, const DVector2 &ray_end, int line_index, const DVector2 &raydelta, double rayd, double raydist2)
 {
 	// Check if two line segments intersects (the ray and the line).
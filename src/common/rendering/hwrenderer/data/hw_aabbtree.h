@@ -35,6 +35,19 @@ struct AABBTreeLine
 	float dx, dy;
 };
 
+// CPU side copy of a node, stored in depth first order so that the tree can be walked front to back without a stack
+struct AABBTreeFlatNode
+{
+	float aabb_left, aabb_top;
+	float aabb_right, aabb_bottom;
+
+	// Index of the next node to visit if the ray misses this one, i.e. the first node after this subtree.
+	int skip;
+
+	// AABBTreeLine index if it is a leaf node. Index is -1 if it is not.
+	int line_index;
+};
+
 class LevelAABBTree
 {
 protected:
@@ -47,10 +60,27 @@ protected:
 	int dynamicStartNode = 0;
 	int dynamicStartLine = 0;
 
+	// Traversal data for the CPU ray tests, built by FinishTree.
+	TArray<AABBTreeFlatNode> flatNodes;
+	TArray<int> flatIndices;	// flat node of each node
+	TArray<int> parentNodes;	// parent of each node, -1 for the root
+	TArray<int> lineLeafs;		// leaf node of each tree line
+
 public:
+	enum
+	{
+		RayPacketSize = 4
+	};
+
 	// Shoot a ray from ray_start to ray_end and return the closest hit as a fractional value between 0 and 1. Returns 1 if no line was hit.
 	double RayTest(const DVector3 &ray_start, const DVector3 &ray_end);
 
+	// Same as RayTest for up to RayPacketSize rays at once. The rays share the node tests, which are done in single precision for all of them together.
+	void RayTestPacket(const DVector3 *ray_start, const DVector3 *ray_end, int count, double *hit_fraction);
+
+	// The original recursive walk over the GPU node layout, kept as the reference for gl_aabbtreebench.
+	double RayTestNodes(const DVector3 &ray_start, const DVector3 &ray_end);
+
 	const void *Nodes() const { return nodes.Data(); }
 	const void *Lines() const { return treelines.Data(); }
 	size_t NodesSize() const { return nodes.Size() * sizeof(AABBTreeNode); }
@@ -70,9 +100,16 @@ public:
 
 protected:
 
-	TArray<int> FindNodePath(unsigned int line, unsigned int node);
+	// Creates the traversal data once all nodes and lines have been added
+	void FinishTree();
+	void AddFlatNode(int node);
+
+	// Moves a line and refits the boxes of all nodes above it
+	void RefitLine(unsigned int line, const AABBTreeLine &treeline);
+
 	// Test if a ray overlaps an AABB node or not
 	bool OverlapRayAABB(const DVector2 &ray_start2d, const DVector2 &ray_end2d, const AABBTreeNode &node);
+	bool OverlapRayAABB(const DVector2 &ray_start, const DVector2 &ray_end, const AABBTreeFlatNode &node);
 
 	// Intersection test between a ray and a line segment
 	double IntersectRayLine(const DVector2 &ray_start, const DVector2 &ray_end, int line_index, const DVector2 &raydelta, double rayd, double raydist2);
@@ -55,6 +55,8 @@ int vertexcount, flatvertices, flatprimitives;
 
 int rendered_lines,rendered_flats,rendered_sprites,render_vertexsplit,render_texsplit,rendered_decals, rendered_portals, rendered_commandbuffers;
 int iter_dlightf, iter_dlight, draw_dlight, draw_dlightf;
+int render_sortsplit, render_sortbinned, render_sorttree;
+int render_spriteprocessed, render_spriteculled;
 
 void ResetProfilingData()
 {
@@ -78,6 +80,8 @@ void ResetProfilingData()
 
 	flatvertices=flatprimitives=vertexcount=0;
 	render_texsplit=render_vertexsplit=rendered_lines=rendered_flats=rendered_sprites=rendered_decals=rendered_portals = 0;
+	render_sortsplit=render_sortbinned=render_sorttree = 0;
+	render_spriteprocessed=render_spriteculled = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -112,8 +116,11 @@ static void AppendRenderStats(FString &out)
 {
 	out.AppendFormat("Walls: %d (%d splits, %d t-splits, %d vertices)\n"
 		"Flats: %d (%d primitives, %d vertices)\n"
-		"Sprites: %d, Decals=%d, Portals: %d, Command buffers: %d\n",
-		rendered_lines, render_vertexsplit, render_texsplit, vertexcount, rendered_flats, flatprimitives, flatvertices, rendered_sprites,rendered_decals, rendered_portals, rendered_commandbuffers );
+		"Sprites: %d, Decals=%d, Portals: %d, Command buffers: %d\n"
+		"Translucent sort: %d binned, %d tree sorted (%d splits)\n"
+		"Things: %d processed, %d culled early\n",
+		rendered_lines, render_vertexsplit, render_texsplit, vertexcount, rendered_flats, flatprimitives, flatvertices, rendered_sprites,rendered_decals, rendered_portals, rendered_commandbuffers,
+		render_sortbinned, render_sorttree, render_sortsplit, render_spriteprocessed, render_spriteculled );
 }
 
 static void AppendLightStats(FString &out)
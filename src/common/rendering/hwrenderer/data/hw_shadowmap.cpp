@@ -91,6 +91,23 @@ bool IShadowMap::ShadowTest(const DVector3 &lpos, const DVector3 &pos)
 		return true;
 }
 
+void IShadowMap::ShadowTest(const DVector3 *lpos, int count, const DVector3 &pos, bool *visible)
+{
+	assert(count <= hwrenderer::LevelAABBTree::RayPacketSize);
+	if (mAABBTree && gl_light_shadowmap)
+	{
+		DVector3 ends[hwrenderer::LevelAABBTree::RayPacketSize];
+		double hits[hwrenderer::LevelAABBTree::RayPacketSize];
+		for (auto &end : ends) end = pos;
+		mAABBTree->RayTestPacket(lpos, ends, count, hits);
+		for (int i = 0; i < count; i++) visible[i] = hits[i] >= 1.0;
+	}
+	else
+	{
+		for (int i = 0; i < count; i++) visible[i] = true;
+	}
+}
+
 bool IShadowMap::PerformUpdate()
 {
 	UpdateCycles.Reset();
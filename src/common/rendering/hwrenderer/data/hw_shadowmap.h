@@ -19,6 +19,9 @@ public:
 	// Test if a world position is in shadow relative to the specified light and returns false if it is
 	bool ShadowTest(const DVector3 &lpos, const DVector3 &pos);
 
+	// Same for up to LevelAABBTree::RayPacketSize lights at once
+	void ShadowTest(const DVector3 *lpos, int count, const DVector3 &pos, bool *visible);
+
 	static cycle_t UpdateCycles;
 	static int LightsProcessed;
 	static int LightsShadowmapped;
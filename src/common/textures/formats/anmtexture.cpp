@@ -53,6 +53,7 @@ public:
 	void ReadFrame(uint8_t *buffer, uint8_t *palette);
 	TArray<uint8_t> CreatePalettedPixels(int conversion) override;
 	int CopyPixels(FBitmap *bmp, int conversion) override;
+	bool SupportsPitchedCopy() override { return false; }
 };
 
 
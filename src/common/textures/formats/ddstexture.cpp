@@ -183,6 +183,7 @@ protected:
 	void DecompressDXT5 (FileReader &lump, bool premultiplied, uint8_t *buffer, int pixelmode);
 
 	int CopyPixels(FBitmap *bmp, int conversion) override;
+	bool SupportsPitchedCopy() override { return false; }
 
 	friend class FTexture;
 };
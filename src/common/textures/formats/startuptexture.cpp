@@ -79,6 +79,7 @@ public:
 	FStartupTexture (int lumpnum);
 	TArray<uint8_t> CreatePalettedPixels(int conversion) override;
 	int CopyPixels(FBitmap *bmp, int conversion) override;
+	bool SupportsPitchedCopy() override { return false; }
 };
 
 class FNotchTexture : public FImageSource
@@ -87,6 +88,7 @@ public:
 	FNotchTexture (int lumpnum, int width, int height);
 	TArray<uint8_t> CreatePalettedPixels(int conversion) override;
 	int CopyPixels(FBitmap *bmp, int conversion) override;
+	bool SupportsPitchedCopy() override { return false; }
 };
 
 class FStrifeStartupTexture : public FImageSource
@@ -91,6 +91,8 @@ class FGameTexture
 	int8_t shouldUpscaleFlag = 1;
 	ETextureType UseType = ETextureType::Wall;	// This texture's primary purpose
 	SpritePositioningInfo* spi = nullptr;
+	FGameTexture* AtlasPage = nullptr;		// shared page this texture was packed into for 2D drawing
+	FloatRect AtlasRect = {};				// position on AtlasPage in texture coordinates
 
 	ISoftwareTexture* SoftwareTexture = nullptr;
 	FMaterial* Material[5] = {  };
@@ -286,6 +288,9 @@ public:
 	}
 
 	const SpritePositioningInfo& GetSpritePositioning(int which) { if (spi == nullptr) SetupSpriteData(); return spi[which]; }
+	FGameTexture* GetAtlasPage() const { return AtlasPage; }
+	const FloatRect& GetAtlasRect() const { return AtlasRect; }
+	void SetAtlasPage(FGameTexture* page, const FloatRect& rect) { AtlasPage = page; AtlasRect = rect; }
 	int GetAreas(FloatRect** pAreas) const;
 
 	bool GetTranslucency()
@@ -40,19 +40,16 @@
 #include "files.h"
 #include "cmdlib.h"
 #include "palettecontainer.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "stats.h"
 
 FMemArena ImageArena(32768);
 TArray<FImageSource *>FImageSource::ImageForLump;
 int FImageSource::NextID;
 static PrecacheInfo precacheInfo;
 
-struct PrecacheDataPaletted
-{
-	TArray<uint8_t> Pixels;
-	int RefCount;
-	int ImageID;
-};
-
 struct PrecacheDataRgba
 {
 	FBitmap Pixels;
@@ -62,9 +59,155 @@ struct PrecacheDataRgba
 };
 
 // TMap doesn't handle this kind of data well.  std::map neither. The linear search is still faster, even for a few 100 entries because it doesn't have to access the heap as often..
-TArray<PrecacheDataPaletted> precacheDataPaletted;
 TArray<PrecacheDataRgba> precacheDataRgba;
 
+CUSTOM_CVARD(Int, r_imagecachesize, 64, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "size limit in MB for cached paletted image data. 0 disables the cache")
+{
+	if (self < 0) self = 0;
+	else FImageSource::TrimImageCache();
+}
+
+//===========================================================================
+//
+// Cache for paletted image data
+//
+// Keeps recently used paletted images around so that patches shared by
+// many composite textures don't get decoded again for each of them.
+// The total size is limited by r_imagecachesize and the least recently
+// used entries get discarded first.
+//
+//===========================================================================
+
+class FPalettedImageCache
+{
+	struct Entry
+	{
+		TArray<uint8_t> Pixels;
+		FImageSource *Image;
+		int ImageID;
+		Entry *Prev, *Next;		// Prev is the more recently used neighbor.
+	};
+
+	TMap<int, Entry *> Entries;
+	Entry *Head = nullptr, *Tail = nullptr;
+	size_t Bytes = 0;
+	uint64_t Hits = 0, Misses = 0, Evictions = 0;
+
+	static size_t EntrySize(const Entry *entry)
+	{
+		return sizeof(Entry) + entry->Pixels.Size();
+	}
+
+	void Unlink(Entry *entry)
+	{
+		if (entry->Prev) entry->Prev->Next = entry->Next;
+		else Head = entry->Next;
+		if (entry->Next) entry->Next->Prev = entry->Prev;
+		else Tail = entry->Prev;
+	}
+
+	void LinkFront(Entry *entry)
+	{
+		entry->Prev = nullptr;
+		entry->Next = Head;
+		if (Head) Head->Prev = entry;
+		else Tail = entry;
+		Head = entry;
+	}
+
+	void Remove(Entry *entry)
+	{
+		Unlink(entry);
+		Entries.Remove(entry->ImageID);
+		Bytes -= EntrySize(entry);
+		delete entry;
+	}
+
+public:
+	~FPalettedImageCache()
+	{
+		Clear();
+	}
+
+	static size_t Limit()
+	{
+		return size_t(*r_imagecachesize) << 20;
+	}
+
+	// The returned array is only valid until the next insertion.
+	const TArray<uint8_t> *Find(int imageid, bool count)
+	{
+		auto pentry = Entries.CheckKey(imageid);
+		if (pentry == nullptr)
+		{
+			if (count) Misses++;
+			return nullptr;
+		}
+		if (count) Hits++;
+		auto entry = *pentry;
+		if (entry != Head)
+		{
+			Unlink(entry);
+			LinkFront(entry);
+		}
+		return &entry->Pixels;
+	}
+
+	// Takes ownership of the pixels if they fit into the cache, otherwise leaves them alone and returns null.
+	const TArray<uint8_t> *Insert(FImageSource *image, int imageid, TArray<uint8_t> &pixels)
+	{
+		size_t size = sizeof(Entry) + pixels.Size();
+		size_t limit = Limit();
+		if (size > limit) return nullptr;
+		Trim(limit - size);
+
+		auto entry = new Entry;
+		entry->Pixels = std::move(pixels);
+		entry->Image = image;
+		entry->ImageID = imageid;
+		LinkFront(entry);
+		Entries.Insert(imageid, entry);
+		Bytes += size;
+		return &entry->Pixels;
+	}
+
+	void Trim(size_t limit)
+	{
+		while (Bytes > limit && Tail != nullptr)
+		{
+			Remove(Tail);
+			Evictions++;
+		}
+	}
+
+	void Clear()
+	{
+		while (Head != nullptr) Remove(Head);
+	}
+
+	FString GetStats() const
+	{
+		uint64_t lookups = Hits + Misses;
+		return FStringf("%u entries, %.2f of %d MB, %.1f%% hit rate (%llu/%llu), %llu evicted",
+			Entries.CountUsed(), Bytes / 1048576., *r_imagecachesize, lookups ? Hits * 100. / lookups : 0.,
+			(unsigned long long)Hits, (unsigned long long)lookups, (unsigned long long)Evictions);
+	}
+
+	void Dump() const
+	{
+		int i = 0;
+		for (auto entry = Head; entry != nullptr; entry = entry->Next)
+		{
+			auto lump = entry->Image->LumpNum();
+			Printf("%4d: %-24s %4dx%-4d %8u bytes\n", i++, lump >= 0 ? fileSystem.GetFileFullName(lump) : "-",
+				entry->Image->GetWidth(), entry->Image->GetHeight(), (unsigned)EntrySize(entry));
+		}
+		Printf("%s\n", GetStats().GetChars());
+	}
+};
+
+static FPalettedImageCache PalettedCache;
+
 //===========================================================================
 // 
 // the default just returns an empty texture.
@@ -78,82 +221,99 @@ TArray<uint8_t> FImageSource::CreatePalettedPixels(int conversion)
 	return Pixels;
 }
 
+//===========================================================================
+//
+// Only the default conversion goes through the cache. The others are
+// only needed for special cases and would just waste space.
+//
+//===========================================================================
+
 PalettedPixels FImageSource::GetCachedPalettedPixels(int conversion)
 {
 	PalettedPixels ret;
 
-	FString name;
-	fileSystem.GetFileShortName(name, SourceLump);
-
-	auto imageID = ImageID;
-
-	// Do we have this image in the cache?
-	unsigned index = conversion != normal? UINT_MAX : precacheDataPaletted.FindEx([=](PrecacheDataPaletted &entry) { return entry.ImageID == imageID; });
-	if (index < precacheDataPaletted.Size())
+	if (conversion == normal)
 	{
-		auto cache = &precacheDataPaletted[index];
-
-		if (cache->RefCount > 1)
-		{
-			//Printf("returning reference to %s, refcount = %d\n", name.GetChars(), cache->RefCount);
-			ret.Pixels.Set(cache->Pixels.Data(), cache->Pixels.Size());
-			cache->RefCount--;
-		}
-		else if (cache->Pixels.Size() > 0)
+		auto cached = PalettedCache.Find(ImageID, true);
+		if (cached == nullptr)
 		{
-			//Printf("returning contents of %s, refcount = %d\n", name.GetChars(), cache->RefCount);
-			ret.PixelStore = std::move(cache->Pixels);
-			ret.Pixels.Set(ret.PixelStore.Data(), ret.PixelStore.Size());
-			precacheDataPaletted.Delete(index);
+			ret.PixelStore = CreatePalettedPixels(normal);
+			cached = PalettedCache.Insert(this, ImageID, ret.PixelStore);
 		}
-		else
+		if (cached != nullptr)
 		{
-			//Printf("something bad happened for %s, refcount = %d\n", name.GetChars(), cache->RefCount);
+			ret.Pixels.Set(cached->Data(), cached->Size());
+			return ret;
 		}
 	}
 	else
 	{
-		// The image wasn't cached. Now there's two possibilities: 
-		auto info = precacheInfo.CheckKey(ImageID);
-		if (!info || info->second <= 1 || conversion != normal)
-		{
-			// This is either the only copy needed or some access outside the caching block. In these cases create a new one and directly return it.
-			//Printf("returning fresh copy of %s\n", name.GetChars());
-			ret.PixelStore = CreatePalettedPixels(conversion);
-			ret.Pixels.Set(ret.PixelStore.Data(), ret.PixelStore.Size());
-		}
-		else
-		{
-			//Printf("creating cached entry for %s, refcount = %d\n", name.GetChars(), info->second);
-			// This is the first time it gets accessed and needs to be placed in the cache.
-			PrecacheDataPaletted *pdp = &precacheDataPaletted[precacheDataPaletted.Reserve(1)];
-
-			pdp->ImageID = imageID;
-			pdp->RefCount = info->second - 1;
-			info->second = 0;
-			pdp->Pixels = CreatePalettedPixels(normal);
-			ret.Pixels.Set(pdp->Pixels.Data(), pdp->Pixels.Size());
-		}
+		ret.PixelStore = CreatePalettedPixels(conversion);
 	}
+	ret.Pixels.Set(ret.PixelStore.Data(), ret.PixelStore.Size());
 	return ret;
 }
 
+//===========================================================================
+//
+// Images that are known to have only one user bypass the cache so that
+// their data doesn't exist twice.
+//
+//===========================================================================
+
 TArray<uint8_t> FImageSource::GetPalettedPixels(int conversion)
 {
-	auto pix = GetCachedPalettedPixels(conversion);
-	if (pix.ownsPixels())
+	if (conversion == normal)
 	{
-		// return the pixel store of the returned data directly if this was the last reference.
-		auto array = std::move(pix.PixelStore);
-		return array;
-	}
-	else
-	{
-		// If there are pending references, make a copy.
-		TArray<uint8_t> array(pix.Pixels.Size(), true);
-		memcpy(array.Data(), pix.Pixels.Data(), array.Size());
-		return array;
+		auto info = precacheInfo.CheckKey(ImageID);
+		if ((info && info->second > 1) || PalettedCache.Find(ImageID, false) != nullptr)
+		{
+			auto pix = GetCachedPalettedPixels(conversion);
+			if (pix.ownsPixels())
+			{
+				// return the pixel store of the returned data directly if the cache did not take it.
+				auto array = std::move(pix.PixelStore);
+				return array;
+			}
+			else
+			{
+				TArray<uint8_t> array(pix.Pixels.Size(), true);
+				memcpy(array.Data(), pix.Pixels.Data(), array.Size());
+				return array;
+			}
+		}
 	}
+	return CreatePalettedPixels(conversion);
+}
+
+//===========================================================================
+//
+//
+//
+//===========================================================================
+
+void FImageSource::TrimImageCache()
+{
+	PalettedCache.Trim(FPalettedImageCache::Limit());
+}
+
+void FImageSource::ClearImages()
+{
+	PalettedCache.Clear();
+	ImageArena.FreeAll();
+	ImageForLump.Clear();
+	NextID = 0;
+}
+
+ADD_STAT(imagecache)
+{
+	return PalettedCache.GetStats();
+}
+
+CCMD(dumpimagecache)
+{
+	PalettedCache.Dump();
+	Printf("Image arena: %s", ImageArena.DumpInfo().GetChars());
 }
 
 
@@ -270,6 +430,46 @@ FBitmap FImageSource::GetCachedBitmap(const PalEntry *remap, int conversion, int
 	return ret;
 }
 
+//==========================================================================
+//
+// Variant of GetCachedBitmap for callers that already own the target
+// buffer. Saves allocating and copying a full size intermediate bitmap
+// whenever the image doesn't have to be kept around for later users.
+//
+//==========================================================================
+
+int FImageSource::CopyCachedPixels(FBitmap *bmp, const PalEntry *remap, int conversion)
+{
+	if (remap != nullptr)
+	{
+		return CopyTranslatedPixels(bmp, remap);
+	}
+	if (conversion == luminance) conversion = normal;
+
+	if (bmp->GetPitch() != Width * 4 && !SupportsPitchedCopy())
+	{
+		int trans;
+		auto Pixels = GetCachedBitmap(nullptr, conversion, &trans);
+		bmp->Blit(0, 0, Pixels);
+		return trans;
+	}
+	if (conversion == normal)
+	{
+		auto imageID = ImageID;
+		unsigned index = precacheDataRgba.FindEx([=](PrecacheDataRgba &entry) { return entry.ImageID == imageID; });
+		auto info = precacheInfo.CheckKey(ImageID);
+		if (index < precacheDataRgba.Size() || (info && info->first > 1))
+		{
+			// Another user is waiting for this image so it has to go through the cache.
+			int trans;
+			auto Pixels = GetCachedBitmap(nullptr, conversion, &trans);
+			bmp->Blit(0, 0, Pixels);
+			return trans;
+		}
+	}
+	return CopyPixels(bmp, conversion);
+}
+
 //==========================================================================
 //
 //
@@ -299,7 +499,6 @@ void FImageSource::BeginPrecaching()
 
 void FImageSource::EndPrecaching()
 {
-	precacheDataPaletted.Clear();
 	precacheDataRgba.Clear();
 }
 
@@ -59,6 +59,7 @@ protected:
 public:
 	virtual bool SupportRemap0() { return false; }		// Unfortunate hackery that's needed for Hexen's skies. Only the image can know about the needed parameters
 	virtual bool IsRawCompatible() { return true; }		// Same thing for mid texture compatibility handling. Can only be determined by looking at the composition data which is private to the image.
+	virtual bool SupportsPitchedCopy() { return true; }	// False for images whose CopyPixels writes to the bitmap directly and assumes its pitch is Width * 4.
 
 	void CopySize(FImageSource &other)
 	{
@@ -80,17 +81,22 @@ public:
 
 	// 'noremap0' will only be looked at by FPatchTexture and forwarded by FMultipatchTexture.
 
-	// Either returns a reference to the cache, or a newly created item. The return of this has to be considered transient. If you need to store the result, use GetPalettedPixels
+	// Either returns a reference to the cache, or a newly created item. The return of this has to be considered transient (i.e. it's only valid until the next call.) If you need to store the result, use GetPalettedPixels
 	PalettedPixels GetCachedPalettedPixels(int conversion);
 
-	// tries to get a buffer from the cache. If not available, create a new one. If further references are pending, create a copy.
+	// tries to get a buffer from the cache. If not available, create a new one. The cache is only filled if further references are pending.
 	TArray<uint8_t> GetPalettedPixels(int conversion);
 
 
 	// Unlile for paletted images there is no variant here that returns a persistent bitmap, because all users have to process the returned image into another format.
 	FBitmap GetCachedBitmap(const PalEntry *remap, int conversion, int *trans = nullptr);
 
-	static void ClearImages() { ImageArena.FreeAll(); ImageForLump.Clear(); NextID = 0; }
+	// Same as above but writes into a caller supplied bitmap, e.g. a view into a texture upload buffer.
+	// Decodes straight into the target if no precached copy exists or is needed.
+	int CopyCachedPixels(FBitmap *bmp, const PalEntry *remap, int conversion);
+
+	static void ClearImages();
+	static void TrimImageCache();
 	static FImageSource * GetImage(int lumpnum, bool checkflat);
 
 
@@ -88,6 +88,17 @@ FBitmap FImageTexture::GetBgraBitmap(const PalEntry *p, int *trans)
 //
 //===========================================================================
 
+int FImageTexture::CopyBgraPixels(FBitmap *bmp, const PalEntry *p)
+{
+	return mImage->CopyCachedPixels(bmp, p, bNoRemap0? FImageSource::noremap0 : FImageSource::normal);
+}
+
+//===========================================================================
+//
+// 
+//
+//===========================================================================
+
 TArray<uint8_t> FImageTexture::Get8BitPixels(bool alpha)
 {
 	return mImage->GetPalettedPixels(alpha? FImageSource::luminance : bNoRemap0 ? FImageSource::noremap0 : FImageSource::normal);
@@ -85,6 +85,24 @@ FBitmap FTexture::GetBgraBitmap(const PalEntry* remap, int* ptrans)
 	return bmp;
 }
 
+//===========================================================================
+//
+// FTexture::CopyBgraPixels
+//
+// Writes the true color image into an existing bitmap and returns the
+// transparency info. Image backed textures override this to decode
+// directly into the target.
+//
+//===========================================================================
+
+int FTexture::CopyBgraPixels(FBitmap *bmp, const PalEntry *remap)
+{
+	int trans = -1;
+	auto Pixels = GetBgraBitmap(remap, &trans);
+	bmp->Blit(0, 0, Pixels);
+	return trans;
+}
+
 //====================================================================
 //
 // CheckRealHeight
@@ -360,11 +378,10 @@ FTextureBuffer FTexture::CreateTexBuffer(int translation, int flags)
 			auto remap = translation <= 0 || IsLuminosityTranslation(translation) ? nullptr : GPalette.TranslationToTable(translation);
 			if (remap && remap->Inactive) remap = nullptr;
 			if (remap) translation = remap->Index;
-			FBitmap bmp(buffer, W * 4, W, H);
+			// Write the image straight into the upload buffer, inside the border reserved for expansion.
+			FBitmap bmp(buffer + (exx * W + exx) * 4, W * 4, GetWidth(), GetHeight());
 
-			int trans;
-			auto Pixels = GetBgraBitmap(remap ? remap->Palette : nullptr, &trans);
-			bmp.Blit(exx, exx, Pixels);
+			int trans = CopyBgraPixels(&bmp, remap ? remap->Palette : nullptr);
 			if (IsLuminosityTranslation(translation))
 			{
 				V_ApplyLuminosityTranslation(translation, buffer, W * H);
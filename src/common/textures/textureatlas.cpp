@@ -0,0 +1,147 @@
+/*
+** textureatlas.cpp
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 GZDoom Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+**
+*/
+
+#include "textureatlas.h"
+#include "texturemanager.h"
+#include "image.h"
+#include "formats/multipatchtexture.h"
+
+//==========================================================================
+//
+// Only plain image based textures without any additional material layers
+// can be drawn from a shared page.
+//
+//==========================================================================
+
+void FTextureAtlasBuilder::Add(FGameTexture* tex)
+{
+	if (tex == nullptr || !tex->isValid() || tex->GetAtlasPage() != nullptr) return;
+	if (tex->isWarped() || tex->isHardwareCanvas() || tex->GetShaderIndex() != 0) return;
+	if (tex->GetTexture()->GetImage() == nullptr) return;
+
+	int w = tex->GetTexelWidth(), h = tex->GetTexelHeight();
+	if (w <= 0 || h <= 0 || w > PageSize / 4 || h > PageSize / 4) return;
+
+	TArray<FTexture*> layers;
+	tex->GetLayers(layers);
+	if (layers.Size() != 1) return;
+
+	Entries.Push({ tex, 0, 0 });
+}
+
+//==========================================================================
+//
+// Packs all added textures into pages using simple shelf packing,
+// tallest textures first. Returns the number of created pages.
+//
+//==========================================================================
+
+int FTextureAtlasBuilder::Build(ETextureType usetype)
+{
+	if (Entries.Size() < 2)
+	{
+		Entries.Clear();
+		return 0;
+	}
+
+	std::stable_sort(Entries.begin(), Entries.end(), [](const Entry& a, const Entry& b)
+	{
+		return a.Texture->GetTexelHeight() > b.Texture->GetTexelHeight();
+	});
+
+	int pages = 0;
+	unsigned pagestart = 0;
+	int x = Padding, y = Padding, shelfheight = 0;
+	for (unsigned i = 0; i < Entries.Size(); i++)
+	{
+		int w = Entries[i].Texture->GetTexelWidth();
+		int h = Entries[i].Texture->GetTexelHeight();
+
+		if (x + w + Padding > PageSize)
+		{
+			x = Padding;
+			y += shelfheight + Padding;
+			shelfheight = 0;
+		}
+		if (y + h + Padding > PageSize)
+		{
+			FlushPage(pagestart, i, y, usetype);
+			pages++;
+			pagestart = i;
+			x = y = Padding;
+			shelfheight = 0;
+		}
+		Entries[i].X = x;
+		Entries[i].Y = y;
+		x += w + Padding;
+		shelfheight = max(shelfheight, h);
+	}
+	FlushPage(pagestart, Entries.Size(), y + shelfheight + Padding, usetype);
+	pages++;
+	Entries.Clear();
+	return pages;
+}
+
+//==========================================================================
+//
+// Creates a page texture from the given entries and links them to it.
+// The page is a multipatch texture so that it supports translations and
+// paletted rendering just like its parts.
+//
+//==========================================================================
+
+void FTextureAtlasBuilder::FlushPage(unsigned first, unsigned last, int height, ETextureType usetype)
+{
+	if (last - first < 2) return;	// not worth a page of its own.
+
+	TArray<TexPartBuild> parts(last - first, true);
+	for (unsigned i = first; i < last; i++)
+	{
+		auto& part = parts[i - first];
+		part.TexImage = static_cast<FImageTexture*>(Entries[i].Texture->GetTexture());
+		part.OriginX = Entries[i].X;
+		part.OriginY = Entries[i].Y;
+	}
+
+	auto page = MakeGameTexture(new FImageTexture(new FMultiPatchTexture(PageSize, height, parts, false, false)), nullptr, usetype);
+	TexMan.AddGameTexture(page, false);
+
+	float fw = float(PageSize), fh = float(height);
+	for (unsigned i = first; i < last; i++)
+	{
+		auto tex = Entries[i].Texture;
+		FloatRect rect = { Entries[i].X / fw, Entries[i].Y / fh, tex->GetTexelWidth() / fw, tex->GetTexelHeight() / fh };
+		tex->SetAtlasPage(page, rect);
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "tarray.h"
+#include "textures.h"
+
+//==========================================================================
+//
+// Packs small textures into shared pages so that the 2D drawer can batch
+// draws using different source textures into a single command.
+//
+// The packed textures remain fully functional on their own, they only get
+// a reference to their page which the 2D drawer may use instead.
+//
+//==========================================================================
+
+class FTextureAtlasBuilder
+{
+public:
+	FTextureAtlasBuilder(int pagesize = 512, int padding = 2)
+		: PageSize(pagesize), Padding(padding)
+	{
+	}
+
+	void Add(FGameTexture* tex);
+	int Build(ETextureType usetype);
+
+private:
+	struct Entry
+	{
+		FGameTexture* Texture;
+		int X, Y;
+	};
+
+	void FlushPage(unsigned first, unsigned last, int height, ETextureType usetype);
+
+	TArray<Entry> Entries;
+	int PageSize;
+	int Padding;
+};
@@ -95,6 +95,7 @@ void FTextureManager::DeleteAll()
 	Translation.Clear();
 	FirstTextureForFile.Clear();
 	memset (HashFirst, -1, sizeof(HashFirst));
+	ClearNameIndex();
 	DefaultTexture.SetInvalid();
 
 	BuildTileData.Clear();
@@ -152,11 +153,74 @@ static FTexture* CreateTextureFromLump(int lumpnum, bool allowflats = false)
 //
 //==========================================================================
 
+bool FTextureManager::CheckTextureMatch(int i, ETextureType usetype, BITFIELD flags, int &firstfound, ETextureType &firsttype, FTextureID &result)
+{
+	auto tex = Textures[i].Texture;
+
+	// If we look for short names, we must ignore any long name texture.
+	if ((flags & TEXMAN_ShortNameOnly) && tex->isFullNameTexture())
+	{
+		return false;
+	}
+	auto texUseType = tex->GetUseType();
+	// The name matches, so check the texture type
+	if (usetype == ETextureType::Any)
+	{
+		// All NULL textures should actually return 0
+		if (texUseType == ETextureType::FirstDefined && !(flags & TEXMAN_ReturnFirst)) result = FTextureID(0);
+		else if (texUseType == ETextureType::SkinGraphic && !(flags & TEXMAN_AllowSkins)) result = FTextureID(0);
+		else result = FTextureID(texUseType==ETextureType::Null ? 0 : i);
+		return true;
+	}
+	else if ((flags & TEXMAN_Overridable) && texUseType == ETextureType::Override)
+	{
+		result = FTextureID(i);
+		return true;
+	}
+	else if (texUseType == usetype)
+	{
+		result = FTextureID(i);
+		return true;
+	}
+	else if (texUseType == ETextureType::FirstDefined && usetype == ETextureType::Wall)
+	{
+		if (!(flags & TEXMAN_ReturnFirst)) result = FTextureID(0);
+		else result = FTextureID(i);
+		return true;
+	}
+	else if (texUseType == ETextureType::Null && usetype == ETextureType::Wall)
+	{
+		// We found a NULL texture on a wall -> return 0
+		result = FTextureID(0);
+		return true;
+	}
+	else
+	{
+		if (firsttype == ETextureType::Null ||
+			(firsttype == ETextureType::MiscPatch &&
+			 texUseType != firsttype &&
+			 texUseType != ETextureType::Null)
+		   )
+		{
+			firstfound = i;
+			firsttype = texUseType;
+		}
+	}
+	return false;
+}
+
+//==========================================================================
+//
+// FTextureManager :: CheckForTexture
+//
+//==========================================================================
+
 FTextureID FTextureManager::CheckForTexture (const char *name, ETextureType usetype, BITFIELD flags)
 {
 	int i;
 	int firstfound = -1;
 	auto firsttype = ETextureType::Null;
+	FTextureID result;
 
 	if (name == NULL || name[0] == '\0')
 	{
@@ -170,56 +234,34 @@ FTextureID FTextureManager::CheckForTexture (const char *name, ETextureType uset
 		return FTextureID(0);
 	}
 
-	for(i = HashFirst[MakeKey(name) % HASH_SIZE]; i != HASH_END; i = Textures[i].HashNext)
-	{
-		auto tex = Textures[i].Texture;
+	uint32_t key = MakeKey(name);
 
+	// Textures added after the name index was built are only found in the hash chain.
+	for(i = HashFirst[key % HASH_SIZE]; i != HASH_END && i >= NameIndexLimit; i = Textures[i].HashNext)
+	{
+		if (stricmp (Textures[i].Texture->GetName(), name) == 0 && CheckTextureMatch(i, usetype, flags, firstfound, firsttype, result))
+		{
+			return result;
+		}
+	}
 
-		if (stricmp (tex->GetName(), name) == 0 )
+	// The rest of the chain is covered by the name index, which only needs a single name compare.
+	if (i != HASH_END)
+	{
+		unsigned mask = NameIndex.Size() - 1;
+		for (unsigned slot = key & mask; NameIndex[slot].Count > 0; slot = (slot + 1) & mask)
 		{
-			// If we look for short names, we must ignore any long name texture.
-			if ((flags & TEXMAN_ShortNameOnly) && tex->isFullNameTexture())
-			{
-				continue;
-			}
-			auto texUseType = tex->GetUseType();
-			// The name matches, so check the texture type
-			if (usetype == ETextureType::Any)
-			{
-				// All NULL textures should actually return 0
-				if (texUseType == ETextureType::FirstDefined && !(flags & TEXMAN_ReturnFirst)) return 0;
-				if (texUseType == ETextureType::SkinGraphic && !(flags & TEXMAN_AllowSkins)) return 0;
-				return FTextureID(texUseType==ETextureType::Null ? 0 : i);
-			}
-			else if ((flags & TEXMAN_Overridable) && texUseType == ETextureType::Override)
-			{
-				return FTextureID(i);
-			}
-			else if (texUseType == usetype)
-			{
-				return FTextureID(i);
-			}
-			else if (texUseType == ETextureType::FirstDefined && usetype == ETextureType::Wall)
+			auto &entry = NameIndex[slot];
+			if (entry.Key == key && stricmp(Textures[NameIndexTextures[entry.First]].Texture->GetName(), name) == 0)
 			{
-				if (!(flags & TEXMAN_ReturnFirst)) return FTextureID(0);
-				else return FTextureID(i);
-			}
-			else if (texUseType == ETextureType::Null && usetype == ETextureType::Wall)
-			{
-				// We found a NULL texture on a wall -> return 0
-				return FTextureID(0);
-			}
-			else
-			{
-				if (firsttype == ETextureType::Null ||
-					(firsttype == ETextureType::MiscPatch &&
-					 texUseType != firsttype &&
-					 texUseType != ETextureType::Null)
-				   )
+				for (int j = 0; j < entry.Count; j++)
 				{
-					firstfound = i;
-					firsttype = texUseType;
+					if (CheckTextureMatch(NameIndexTextures[entry.First + j], usetype, flags, firstfound, firsttype, result))
+					{
+						return result;
+					}
 				}
+				break;
 			}
 		}
 	}
@@ -1056,6 +1098,9 @@ void FTextureManager::SortTexturesByType(int start, int end)
 {
 	TArray<FGameTexture *> newtextures;
 
+	// The texture order is about to change.
+	ClearNameIndex();
+
 	// First unlink all newly added textures from the hash chain
 	for (int i = 0; i < HASH_SIZE; i++)
 	{
@@ -1257,6 +1302,90 @@ void FTextureManager::AddTextures(void (*progressFunc_)(), void (*checkForHacks)
 		Textures[i].Texture->SetID(i);
 	}
 
+	BuildNameIndex();
+}
+
+//==========================================================================
+//
+// FTextureManager :: BuildNameIndex
+//
+// Groups all hashed textures by name into an open addressing table so that
+// CheckForTexture can skip over all the unrelated entries in a hash chain.
+// The per-name lists keep the hash chain order so that lookups return the
+// same result as the plain chain walk.
+//
+//==========================================================================
+
+void FTextureManager::BuildNameIndex()
+{
+	ClearNameIndex();
+
+	TArray<int> slotForTexture(Textures.Size(), true);
+	unsigned count = 0;
+	for (int b = 0; b < HASH_SIZE; b++)
+	{
+		for (int i = HashFirst[b]; i != HASH_END; i = Textures[i].HashNext) count++;
+	}
+
+	unsigned size = 16;
+	while (size < count * 2) size <<= 1;
+	NameIndex.Resize(size);
+	memset(NameIndex.Data(), 0, size * sizeof(NameIndexSlot));
+	unsigned mask = size - 1;
+
+	// First pass: assign each texture a slot and count the textures per name.
+	for (int b = 0; b < HASH_SIZE; b++)
+	{
+		for (int i = HashFirst[b]; i != HASH_END; i = Textures[i].HashNext)
+		{
+			const char *name = Textures[i].Texture->GetName().GetChars();
+			uint32_t key = MakeKey(name);
+			unsigned slot = key & mask;
+			while (NameIndex[slot].Count > 0 && (NameIndex[slot].Key != key || stricmp(Textures[NameIndex[slot].First].Texture->GetName(), name) != 0))
+			{
+				slot = (slot + 1) & mask;
+			}
+			if (NameIndex[slot].Count == 0)
+			{
+				NameIndex[slot].Key = key;
+				NameIndex[slot].First = i;	// temporarily holds a texture with this name for the compare above.
+			}
+			NameIndex[slot].Count++;
+			slotForTexture[i] = slot;
+		}
+	}
+
+	// Second pass: lay out the per-name lists in chain order.
+	TArray<int> fill(size, true);
+	int first = 0;
+	for (unsigned slot = 0; slot < size; slot++)
+	{
+		NameIndex[slot].First = first;
+		fill[slot] = first;
+		first += NameIndex[slot].Count;
+	}
+	NameIndexTextures.Resize(count);
+	for (int b = 0; b < HASH_SIZE; b++)
+	{
+		for (int i = HashFirst[b]; i != HASH_END; i = Textures[i].HashNext)
+		{
+			NameIndexTextures[fill[slotForTexture[i]]++] = i;
+		}
+	}
+	NameIndexLimit = Textures.Size();
+}
+
+//==========================================================================
+//
+// FTextureManager :: ClearNameIndex
+//
+//==========================================================================
+
+void FTextureManager::ClearNameIndex()
+{
+	NameIndex.Clear();
+	NameIndexTextures.Clear();
+	NameIndexLimit = 0;
 }
 
 //==========================================================================
@@ -172,6 +172,9 @@ public:
 private:
 
 	void InitPalettedVersions();
+	void BuildNameIndex();
+	void ClearNameIndex();
+	bool CheckTextureMatch(int i, ETextureType usetype, BITFIELD flags, int &firstfound, ETextureType &firsttype, FTextureID &result);
 
 	// Switches
 
@@ -188,6 +191,19 @@ private:
 	TArray<TextureHash> Textures;
 	TMap<uint64_t, int> LocalizedTextures;
 	int HashFirst[HASH_SIZE];
+
+	// Read-only name index built once all textures have been added.
+	// Each slot covers one name and lists all textures by that name in hash chain order.
+	// Textures added later are only in the hash chains and always precede the indexed ones there.
+	struct NameIndexSlot
+	{
+		uint32_t Key;
+		int First;
+		int Count;
+	};
+	TArray<NameIndexSlot> NameIndex;
+	TArray<int> NameIndexTextures;
+	int NameIndexLimit = 0;	// all textures below this index are covered by the name index
 	FTextureID DefaultTexture;
 	TArray<int> FirstTextureForFile;
 	TArray<TArray<uint8_t> > BuildTileData;
@@ -213,3 +229,40 @@ public:
 
 extern FTextureManager TexMan;
 
+//==========================================================================
+//
+// Memoizes CheckForTexture results for one use type and flag combination.
+// Meant for bulk lookups like map loading where the same few hundred names
+// get queried for many thousands of sidedefs and sectors.
+//
+//==========================================================================
+
+class FTextureLookupCache
+{
+	TMap<FName, FTextureID> Cache;
+	ETextureType UseType;
+	BITFIELD Flags;
+
+public:
+	FTextureLookupCache(ETextureType usetype, BITFIELD flags)
+		: UseType(usetype), Flags(flags)
+	{
+	}
+
+	FTextureID CheckForTexture(const char *name)
+	{
+		if (name == nullptr || name[0] == 0) return TexMan.CheckForTexture(name, UseType, Flags);
+		FName fname(name);
+		auto check = Cache.CheckKey(fname);
+		if (check) return *check;
+		FTextureID texid = TexMan.CheckForTexture(name, UseType, Flags);
+		Cache.Insert(fname, texid);
+		return texid;
+	}
+
+	void Clear()
+	{
+		Cache.Clear();
+	}
+};
+
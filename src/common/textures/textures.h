@@ -276,6 +276,7 @@ public:
 	// Returns the whole texture, stored in column-major order
 	virtual TArray<uint8_t> Get8BitPixels(bool alphatex);
 	virtual FBitmap GetBgraBitmap(const PalEntry *remap, int *trans = nullptr);
+	virtual int CopyBgraPixels(FBitmap *bmp, const PalEntry *remap);
 
 	static bool SmoothEdges(unsigned char * buffer,int w, int h);
 
@@ -386,6 +387,7 @@ public:
 
 	FImageSource* GetImage() const override { return mImage; }
 	FBitmap GetBgraBitmap(const PalEntry* p, int* trans) override;
+	int CopyBgraPixels(FBitmap* bmp, const PalEntry* p) override;
 	bool DetermineTranslucency() override;
 
 };
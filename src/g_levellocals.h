@@ -89,6 +89,38 @@ struct FPortalBits
 	}
 };
 
+//============================================================================
+//
+// Uniform grid over the map that stores for each cell the deepest BSP node
+// that contains the entire cell - or the subsector if the cell lies
+// completely within one - so that point lookups can skip the upper levels
+// of the tree. The entries are tagged like node_t::children.
+//
+//============================================================================
+
+struct FSubsectorGrid
+{
+	TArray<void *> cells;
+	int64_t orgx = 0, orgy = 0;
+	int width = 0, height = 0;
+	int shift = 0;
+
+	void Build(const FLevelLocals *Level, node_t *head);
+	void Clear()
+	{
+		cells.Reset();
+		width = height = 0;
+	}
+
+	void *GetStart(fixed_t x, fixed_t y) const
+	{
+		int64_t cx = (x - orgx) >> shift;
+		int64_t cy = (y - orgy) >> shift;
+		if (cx < 0 || cy < 0 || cx >= width || cy >= height) return nullptr;
+		return cells[unsigned(cy * width + cx)];
+	}
+};
+
 class DACSThinker;
 class DFraggleThinker;
 class DSpotState;
@@ -446,6 +478,8 @@ public:
 	TArray<subsector_t> gamesubsectors;
 	TArray<node_t> gamenodes;
 	node_t *headgamenode;
+	FSubsectorGrid gamesubsectorgrid;	// for PointInSubsector
+	FSubsectorGrid rendersubsectorgrid;	// for PointInRenderSubsector
 	TArray<uint8_t> rejectmatrix;
 	TArray<zone_t>	Zones;
 	TArray<FPolyObj> Polyobjects;
@@ -2,18 +2,19 @@
 #define __P_BLOCKMAP_H
 
 #include "doomtype.h"
+#include "tarray.h"
 
 class AActor;
 
 // [RH] Like msecnode_t, but for the blockmap
+// There is one of these for each block an actor is linked into. The block
+// itself only stores the actor in its compact thing array (see FBlockThing).
 struct FBlockNode
 {
 	AActor *Me;						// actor this node references
-	int BlockIndex;					// index into blocklinks for the block this node is in
+	int BlockIndex;					// index into blockthings for the block this node is in
+	int ThingIndex;					// index of this node's entry in that block's thing array
 	int Group;						// portal group this link belongs to (can be different than the actor's own group
-	FBlockNode **PrevActor;			// previous actor in this block
-	FBlockNode *NextActor;			// next actor in this block
-	FBlockNode **PrevBlock;			// previous block this actor is in
 	FBlockNode *NextBlock;			// next block this actor is in
 
 	static FBlockNode *Create (AActor *who, int x, int y, int group = -1);
@@ -22,6 +23,13 @@ struct FBlockNode
 	static FBlockNode *FreeBlocks;
 };
 
+// An entry in a block's thing array.
+struct FBlockThing
+{
+	AActor *Me;
+	FBlockNode *Node;
+};
+
 // BLOCKMAP
 // Created from axis aligned bounding box
 // of the map, a rectangular array of
@@ -39,20 +47,24 @@ struct FBlockmap
 	int					bmapheight; 	// in mapblocks
 	double				bmaporgx;
 	double				bmaporgy;		// origin of block map
-	FBlockNode**		blocklinks; 	// for thing chains
+	TArray<FBlockThing>*	blockthings;	// things in each block, the most recently linked one is last
 
 	// mapblocks are used to check movement
 	// against lines and things
-	static constexpr int MAPBLOCKUNITS = 128;
+	static constexpr int MAPBLOCKSHIFT = 7;
+	static constexpr int MAPBLOCKUNITS = 1 << MAPBLOCKSHIFT;	// the size used by BLOCKMAP lumps
+
+	// Generated blockmaps may use a different size, depending on the map.
+	int					blockunits = MAPBLOCKUNITS;
 
 	inline int GetBlockX(double xpos)
 	{
-		return int((xpos - bmaporgx) / MAPBLOCKUNITS);
+		return int((xpos - bmaporgx) / blockunits);
 	}
 
 	inline int GetBlockY(double ypos)
 	{
-		return int((ypos - bmaporgy) / MAPBLOCKUNITS);
+		return int((ypos - bmaporgy) / blockunits);
 	}
 
 	inline bool isValidBlock(int x, int y) const
@@ -72,6 +84,41 @@ struct FBlockmap
 
 	bool VerifyBlockMap(int count, unsigned numlines);
 
+	// Removing a thing keeps the order of the remaining ones intact, so that
+	// iterating a block from the end yields the same order as the old linked lists.
+	void LinkThing(FBlockNode *node)
+	{
+		FBlockThing entry = { node->Me, node };
+		node->ThingIndex = blockthings[node->BlockIndex].Push(entry);
+	}
+
+	int UnlinkThing(FBlockNode *node, FBlockThing *removed = nullptr)
+	{
+		auto &things = blockthings[node->BlockIndex];
+		int index = node->ThingIndex;
+		assert(things[index].Node == node);
+		if (removed) *removed = things[index];
+		things.Delete(index);
+		RenumberThings(things, index);
+		return index;
+	}
+
+	void RelinkThing(const FBlockThing &entry, int index)
+	{
+		auto &things = blockthings[entry.Node->BlockIndex];
+		things.Insert(index, entry);
+		RenumberThings(things, index);
+	}
+
+	// The entries from index on have moved, so their nodes need to know their new position.
+	static void RenumberThings(TArray<FBlockThing> &things, unsigned index)
+	{
+		for (unsigned i = index; i < things.Size(); i++)
+		{
+			things[i].Node->ThingIndex = i;
+		}
+	}
+
 	void Clear()
 	{
 		if (blockmaplump != nullptr)
@@ -79,10 +126,10 @@ struct FBlockmap
 			delete[] blockmaplump;
 			blockmaplump = nullptr;
 		}
-		if (blocklinks != nullptr)
+		if (blockthings != nullptr)
 		{
-			delete[] blocklinks;
-			blocklinks = nullptr;
+			delete[] blockthings;
+			blockthings = nullptr;
 		}
 	}
 
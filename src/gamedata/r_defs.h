@@ -710,6 +710,7 @@ struct sector_t
 	double			vboheight[HW_MAX_PIPELINE_BUFFERS][2];	// Last calculated height for the 2 planes of this actual sector
 	int				vbocount[2];	// Total count of vertices belonging to this sector's planes. This is used when a sector height changes and also contains all attached planes.
 	int				ibocount;		// number of indices per plane (identical for all planes.) If this is -1 the index buffer is not in use.
+	int				changecount;	// incremented by the setters for properties walls depend on. Used by the hardware renderer's wall cache.
 
 	bool HasLightmaps = false;		// Sector has lightmaps, each subsector vertex needs its own unique lightmap UV data
 
@@ -947,11 +948,13 @@ public:
 	void SetGlowHeight(int pos, float height)
 	{
 		planes[pos].GlowHeight = height;
+		changecount++;
 	}
 
 	void SetGlowColor(int pos, PalEntry color)
 	{
 		planes[pos].GlowColor = color;
+		changecount++;
 	}
 
 	FTextureID GetTexture(int pos) const
@@ -963,6 +966,7 @@ public:
 	{
 		FTextureID old = planes[pos].Texture;
 		planes[pos].Texture = tex;
+		changecount++;
 		if (floorclip && pos == floor && tex != old) AdjustFloorClip();
 	}
 
@@ -979,6 +983,7 @@ public:
 	void SetPlaneTexZ(int pos, double val, bool dirtify = false)	// This mainly gets used by init code. The only place where it must set the vertex to dirty is the interpolation code.
 	{
 		planes[pos].TexZ = val;
+		changecount++;
 		if (dirtify) SetAllVerticesDirty();
 		CheckOverlap();
 	}
@@ -986,6 +991,7 @@ public:
 	void ChangePlaneTexZ(int pos, double val)
 	{
 		planes[pos].TexZ += val;
+		changecount++;
 		SetAllVerticesDirty();
 		CheckOverlap();
 	}
@@ -998,11 +1004,13 @@ public:
 	void ChangeLightLevel(int newval)
 	{
 		lightlevel = ClampLight(lightlevel + newval);
+		changecount++;
 	}
 
 	void SetLightLevel(int newval)
 	{
 		lightlevel = ClampLight(newval);
+		changecount++;
 	}
 
 	int GetLightLevel() const
@@ -1051,6 +1059,7 @@ public:
 	void SetSpecialColor(int slot, int r, int g, int b)
 	{
 		SpecialColors[slot] = PalEntry(255, r, g, b);
+		changecount++;
 		if ((slot == sector_t::wallbottom || slot == sector_t::walltop) && SpecialColors[slot] != 0xffffffff) CheckExColorFlag();
 	}
 
@@ -1058,6 +1067,7 @@ public:
 	{
 		rgb.a = 255;
 		SpecialColors[slot] = rgb;
+		changecount++;
 		if ((slot == sector_t::wallbottom || slot == sector_t::walltop) && rgb != 0xffffffff) CheckExColorFlag();
 	}
 
@@ -1065,6 +1075,7 @@ public:
 	{
 		rgb.a = 255;
 		AdditiveColors[slot] = rgb;
+		changecount++;
 		if ((slot == sector_t::walltop) && AdditiveColors[slot] != 0xffffffff) CheckExColorFlag(); // Wallbottom of this is not used.
 
 	}
@@ -1075,6 +1086,7 @@ public:
 	{
 		if (tm) planes[slot].TextureFx = *tm;	// this is for getting the data from a texture.
 		else planes[slot].TextureFx = {};
+		changecount++;
 	}
 
 
@@ -1232,16 +1244,19 @@ struct side_t
 	seg_t **segs;	// all segs belonging to this sidedef in ascending order. Used for precise rendering
 	int numsegs;
 	int sidenum;
+	int changecount;	// incremented by all setters below, see sector_t::changecount
 
 	int GetLightLevel (bool foggy, int baselight, int which, bool is3dlight=false, int *pfakecontrast_usedbygzdoom=NULL) const;
 
 	void SetLight(int16_t l)
 	{
+		changecount++;
 		Light = l;
 	}
 
 	void SetLight(int16_t l, int which)
 	{
+		changecount++;
 		TierLights[which] = l;
 	}
 
@@ -1257,16 +1272,19 @@ struct side_t
 	}
 	void SetTexture(int which, FTextureID tex)
 	{
+		changecount++;
 		textures[which].texture = tex;
 	}
 
 	void SetTextureXOffset(int which, double offset)
 	{
+		changecount++;
 		textures[which].xOffset = offset;;
 	}
 	
 	void SetTextureXOffset(double offset)
 	{
+		changecount++;
 		textures[top].xOffset =
 		textures[mid].xOffset =
 		textures[bottom].xOffset = offset;
@@ -1279,16 +1297,19 @@ struct side_t
 
 	void AddTextureXOffset(int which, double delta)
 	{
+		changecount++;
 		textures[which].xOffset += delta;
 	}
 
 	void SetTextureYOffset(int which, double offset)
 	{
+		changecount++;
 		textures[which].yOffset = offset;
 	}
 
 	void SetTextureYOffset(double offset)
 	{
+		changecount++;
 		textures[top].yOffset =
 		textures[mid].yOffset =
 		textures[bottom].yOffset = offset;
@@ -1301,16 +1322,19 @@ struct side_t
 
 	void AddTextureYOffset(int which, double delta)
 	{
+		changecount++;
 		textures[which].yOffset += delta;
 	}
 
 	void SetTextureXScale(int which, double scale)
 	{
+		changecount++;
 		textures[which].xScale = scale == 0 ? 1. : scale;
 	}
 
 	void SetTextureXScale(double scale)
 	{
+		changecount++;
 		textures[top].xScale = textures[mid].xScale = textures[bottom].xScale = scale == 0 ? 1. : scale;
 	}
 
@@ -1321,16 +1345,19 @@ struct side_t
 
 	void MultiplyTextureXScale(int which, double delta)
 	{
+		changecount++;
 		textures[which].xScale *= delta;
 	}
 
 	void SetTextureYScale(int which, double scale)
 	{
+		changecount++;
 		textures[which].yScale = scale == 0 ? 1. : scale;
 	}
 
 	void SetTextureYScale(double scale)
 	{
+		changecount++;
 		textures[top].yScale = textures[mid].yScale = textures[bottom].yScale = scale == 0 ? 1. : scale;
 	}
 
@@ -1341,6 +1368,7 @@ struct side_t
 
 	void MultiplyTextureYScale(int which, double delta)
 	{
+		changecount++;
 		textures[which].yScale *= delta;
 	}
 
@@ -1351,12 +1379,14 @@ struct side_t
 
 	void ChangeTextureFlags(int which, int And, int Or)
 	{
+		changecount++;
 		textures[which].flags &= ~And;
 		textures[which].flags |= Or;
 	}
 
 	void SetSpecialColor(int which, int slot, int r, int g, int b, bool useown = true)
 	{
+		changecount++;
 		textures[which].SpecialColors[slot] = PalEntry(255, r, g, b);
 		if (useown) textures[which].flags |= part::UseOwnSpecialColors;
 		else  textures[which].flags &= ~part::UseOwnSpecialColors;
@@ -1365,6 +1395,7 @@ struct side_t
 
 	void SetSpecialColor(int which, int slot, PalEntry rgb, bool useown = true)
 	{
+		changecount++;
 		rgb.a = 255;
 		textures[which].SpecialColors[slot] = rgb;
 		if (useown) textures[which].flags |= part::UseOwnSpecialColors;
@@ -1384,6 +1415,7 @@ struct side_t
 
 	void EnableAdditiveColor(int which, bool enable)
 	{
+		changecount++;
 		const int flag = part::UseOwnAdditiveColor;
 		if (enable)
 		{
@@ -1398,12 +1430,14 @@ struct side_t
 
 	void SetAdditiveColor(int which, PalEntry rgb)
 	{
+		changecount++;
 		rgb.a = 255;
 		textures[which].AdditiveColor = rgb;
 	}
 
 	void SetTextureFx(int slot, const TextureManipulation* tm)
 	{
+		changecount++;
 		if (tm)
 		{
 			textures[slot].TextureFx = *tm;	// this is for getting the data from a texture.
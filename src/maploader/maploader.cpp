@@ -83,6 +83,7 @@
 #include "vm.h"
 #include "texturemanager.h"
 #include "hw_vertexbuilder.h"
+#include "hwrenderer/scene/hw_wallcache.h"
 #include "version.h"
 
 enum
@@ -163,8 +164,7 @@ void MapLoader::SetTexture (side_t *side, int position, const char *name, FMissi
 	static const char *positionnames[] = { "top", "middle", "bottom" };
 	static const char *sidenames[] = { "first", "second" };
 
-	FTextureID texture = TexMan.CheckForTexture (name, ETextureType::Wall,
-			FTextureManager::TEXMAN_Overridable|FTextureManager::TEXMAN_TryAny);
+	FTextureID texture = WallTextureLookup.CheckForTexture(name);
 
 	if (!texture.Exists())
 	{
@@ -209,8 +209,7 @@ void MapLoader::SetTexture (sector_t *sector, int index, int position, const cha
 		name = name8;
 	}
 
-	FTextureID texture = TexMan.CheckForTexture (name, ETextureType::Flat,
-			FTextureManager::TEXMAN_Overridable|FTextureManager::TEXMAN_TryAny);
+	FTextureID texture = FlatTextureLookup.CheckForTexture(name);
 
 	if (!texture.Exists())
 	{
@@ -263,8 +262,7 @@ void MapLoader::SetTexture (side_t *side, int position, uint32_t *blend, const c
 	FTextureID texture;
 	if ((*blend = R_ColormapNumForName (name)) == 0)
 	{
-		texture = TexMan.CheckForTexture (name, ETextureType::Wall,
-			FTextureManager::TEXMAN_Overridable|FTextureManager::TEXMAN_TryAny);
+		texture = WallTextureLookup.CheckForTexture(name);
 		if (!texture.Exists())
 		{
 			char name2[9];
@@ -296,8 +294,7 @@ void MapLoader::SetTextureNoErr (side_t *side, int position, uint32_t *color, co
 {
 	FTextureID texture;
 	*validcolor = false;
-	texture = TexMan.CheckForTexture (name, ETextureType::Wall,	
-		FTextureManager::TEXMAN_Overridable|FTextureManager::TEXMAN_TryAny);
+	texture = WallTextureLookup.CheckForTexture(name);
 	if (!texture.Exists())
 	{
 		char name2[9];
@@ -2322,14 +2319,59 @@ static void CreatePackedBlockmap (TArray<int> &BlockMap, TArray<int> *blocks, in
 }
 
 
-void MapLoader::CreateBlockMap ()
+//===========================================================================
+//
+// MapLoader::ChooseBlockBits
+//
+// Picks the block size for a generated blockmap. Huge, sparse maps get
+// larger blocks so that most of the blockmap isn't empty space, small
+// maps packed with lines and things get smaller ones. Everything else
+// keeps the usual 128 units.
+//
+//===========================================================================
+
+int MapLoader::ChooseBlockBits(double width, double height)
 {
 	enum
 	{
-		BLOCKBITS = 7,
-		BLOCKSIZE = 128
+		MAXBLOCKS = 256 * 256,		// more blocks than this is considered a huge map
+		FINEBLOCKS = 64 * 64,		// only maps with fewer blocks than this are allowed to use smaller ones
+		MAXBLOCKBITS = 10,
+		MINBLOCKBITS = 6
 	};
 
+	int bits = FBlockmap::MAPBLOCKSHIFT;
+	double blocks = (width / FBlockmap::MAPBLOCKUNITS + 1) * (height / FBlockmap::MAPBLOCKUNITS + 1);
+	double density = (Level->lines.Size() + MapThingsConverted.Size()) / blocks;
+
+	if (blocks > MAXBLOCKS)
+	{
+		// Each step quarters the block count, stop once the blocks start to fill up.
+		while (bits < MAXBLOCKBITS && blocks > MAXBLOCKS && density < 4)
+		{
+			bits++;
+			blocks /= 4;
+			density *= 4;
+		}
+	}
+	else if (blocks <= FINEBLOCKS && density > 16)
+	{
+		bits = MINBLOCKBITS;
+	}
+	return bits;
+}
+
+//===========================================================================
+//
+// MapLoader::CreateBlockMap
+//
+//===========================================================================
+
+void MapLoader::CreateBlockMap (int blockbits)
+{
+	const int BLOCKBITS = blockbits;
+	const int BLOCKSIZE = 1 << blockbits;
+
 	TArray<int> *block, *endblock;
 	TArray<TArray<int>> BlockLists;
 	int adder;
@@ -2581,6 +2623,36 @@ bool FBlockmap::VerifyBlockMap(int count, unsigned numlines)
 	return true;
 }
 
+//===========================================================================
+//
+// MapLoader::GenerateBlockMap
+//
+// Creates a blockmap for a map that doesn't have a usable one,
+// with a block size fitting the map.
+//
+//===========================================================================
+
+void MapLoader::GenerateBlockMap()
+{
+	if (Level->vertexes.Size() == 0) return;
+
+	double minx, maxx, miny, maxy;
+	minx = maxx = Level->vertexes[0].fX();
+	miny = maxy = Level->vertexes[0].fY();
+	for (auto &vert : Level->vertexes)
+	{
+		minx = min(minx, vert.fX());
+		maxx = max(maxx, vert.fX());
+		miny = min(miny, vert.fY());
+		maxy = max(maxy, vert.fY());
+	}
+
+	int bits = ChooseBlockBits(maxx - minx, maxy - miny);
+	DPrintf (DMSG_SPAMMY, "Generating BLOCKMAP with %d unit blocks\n", 1 << bits);
+	CreateBlockMap (bits);
+	Level->blockmap.blockunits = 1 << bits;
+}
+
 //===========================================================================
 //
 // P_LoadBlockMap
@@ -2596,13 +2668,18 @@ void MapLoader::LoadBlockMap (MapData * map)
 {
 	int count = map->Size(ML_BLOCKMAP);
 
-	if (ForceNodeBuild || genblockmap ||
-		count/2 >= 0x10000 || count == 0 ||
-		Args->CheckParm("-blockmap")
-		)
+	Level->blockmap.blockunits = FBlockmap::MAPBLOCKUNITS;
+
+	// Only maps which cannot use their BLOCKMAP lump get to choose a block size.
+	// Otherwise the result would depend on the local settings.
+	if (count/2 >= 0x10000 || count == 0)
+	{
+		GenerateBlockMap();
+	}
+	else if (ForceNodeBuild || genblockmap || Args->CheckParm("-blockmap"))
 	{
 		DPrintf (DMSG_SPAMMY, "Generating BLOCKMAP\n");
-		CreateBlockMap ();
+		CreateBlockMap (FBlockmap::MAPBLOCKSHIFT);
 	}
 	else
 	{
@@ -2631,8 +2708,7 @@ void MapLoader::LoadBlockMap (MapData * map)
 
 		if (!Level->blockmap.VerifyBlockMap(count, Level->lines.Size()))
 		{
-			DPrintf (DMSG_SPAMMY, "Generating BLOCKMAP\n");
-			CreateBlockMap();
+			GenerateBlockMap();
 		}
 
 	}
@@ -2644,8 +2720,7 @@ void MapLoader::LoadBlockMap (MapData * map)
 
 	// clear out mobj chains
 	count = Level->blockmap.bmapwidth*Level->blockmap.bmapheight;
-	Level->blockmap.blocklinks = new FBlockNode *[count];
-	memset (Level->blockmap.blocklinks, 0, count*sizeof(*Level->blockmap.blocklinks));
+	Level->blockmap.blockthings = new TArray<FBlockThing>[count];
 	Level->blockmap.blockmap = Level->blockmap.blockmaplump+4;
 }
 
@@ -3190,6 +3265,10 @@ void MapLoader::LoadLevel(MapData *map, const char *lumpname, int position)
 	// Create the item indices, after the last function which may change the data has run.
 	CalcIndices();
 
+	// The node trees are final now, so the lookup grids can be built.
+	Level->gamesubsectorgrid.Build(Level, Level->HeadGamenode());
+	Level->rendersubsectorgrid.Build(Level, Level->HeadNode());
+
 	Level->bodyqueslot = 0;
 	// phares 8/10/98: Clear body queue so the corpses from previous games are
 	// not assumed to be from this one.
@@ -3248,6 +3327,7 @@ void MapLoader::LoadLevel(MapData *map, const char *lumpname, int position)
 	InitRenderInfo();				// create hardware independent renderer resources for the level. This must be done BEFORE the PolyObj Spawn!!!
 	Level->ClearDynamic3DFloorData();	// CreateVBO must be run on the plain 3D floor data.
 	CreateVBO(screen->mVertexData, Level->sectors);
+	WallCache.Clear();				// the cached walls point into the old level's data.
 
 	screen->InitLightmap(Level->LMTextureSize, Level->LMTextureCount, Level->LMTextureData);
 
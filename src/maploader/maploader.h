@@ -2,6 +2,7 @@
 
 #include "nodebuild.h"
 #include "g_levellocals.h"
+#include "texturemanager.h"
 
 class FileReader;
 struct FStrifeDialogueNode;
@@ -115,6 +116,10 @@ private:
 	int sidecount = 0;
 	TArray<int>		linemap;
 	TArray<sidei_t> sidetemp;
+
+	// Texture name lookups are memoized since most maps only use a few hundred distinct names.
+	FTextureLookupCache WallTextureLookup{ ETextureType::Wall, FTextureManager::TEXMAN_Overridable | FTextureManager::TEXMAN_TryAny };
+	FTextureLookupCache FlatTextureLookup{ ETextureType::Flat, FTextureManager::TEXMAN_Overridable | FTextureManager::TEXMAN_TryAny };
 public:	// for the scripted compatibility system these two members need to be public.
 	TArray<FMapThing> MapThingsConverted;
 	bool ForceNodeBuild = false;
@@ -228,7 +233,9 @@ private:
 	void AllocateSideDefs(MapData *map, int count);
 	void ProcessSideTextures(bool checktranmap, side_t *sd, sector_t *sec, intmapsidedef_t *msd, int special, int tag, short *alpha, FMissingTextureTracker &missingtex);
 	void SetMapThingUserData(AActor *actor, unsigned udi);
-	void CreateBlockMap();
+	int ChooseBlockBits(double width, double height);
+	void CreateBlockMap(int blockbits);
+	void GenerateBlockMap();
 	void PO_Init(void);
 
 	// During map init the items' own Index functions should not be used.
@@ -345,6 +345,8 @@ void FLevelLocals::ClearLevelData(bool fullgc)
 	vertexes.Clear();
 	nodes.Clear();
 	gamenodes.Reset();
+	gamesubsectorgrid.Clear();
+	rendersubsectorgrid.Clear();
 	subsectors.Clear();
 	gamesubsectors.Reset();
 	rejectmatrix.Clear();
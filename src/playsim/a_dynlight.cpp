@@ -64,9 +64,12 @@
 #include "a_dynlight.h"
 #include "actorinlines.h"
 #include "memarena.h"
+#include "stats.h"
+#include "ctpl.h"
 
 static FMemArena DynLightArena(sizeof(FDynamicLight) * 200);
 static TArray<FDynamicLight*> FreeList;
+static TArray<FDynamicLight*> PendingLinks;	// lights waiting for LinkPendingLights
 static FRandom randLight;
 
 extern TArray<FLightDefaults *> StateLights;
@@ -204,6 +207,12 @@ DEFINE_ACTION_FUNCTION_NATIVE(ADynamicLight, SetOffset, SetOffset)
 
 void FDynamicLight::ReleaseLight()
 {
+	if (linkpending)
+	{
+		auto index = PendingLinks.Find(this);
+		if (index < PendingLinks.Size()) PendingLinks[index] = nullptr;
+		linkpending = false;
+	}
 	assert(prev != nullptr || this == Level->lights);
 	if (prev != nullptr) prev->next = next;
 	else Level->lights = next;
@@ -407,7 +416,7 @@ void FDynamicLight::UpdateLocation()
 		if (X() != oldx || Y() != oldy || radius != oldradius)
 		{
 			//Update the light lists
-			LinkLight();
+			QueueLink();
 		}
 	}
 }
@@ -522,23 +531,93 @@ double FDynamicLight::DistToSeg(const DVector3 &pos, vertex_t *start, vertex_t *
 
 //==========================================================================
 //
-// Collect all touched sidedefs and subsectors
-// to sidedefs and sector parts.
+// Light linking is split in two: collecting the touched sections and
+// sides only reads the level, so pending lights get collected in parallel,
+// each worker with its own visit marks and output buffers. Inserting the
+// nodes into the shared lists afterwards is done on the main thread.
 //
 //==========================================================================
+
 struct LightLinkEntry
 {
 	FSection *sect;
 	DVector3 pos;
 };
-static TArray<LightLinkEntry> collected_ss;
 
-void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section, float radius)
+struct FLightLinkWorker
+{
+	TArray<int> SectionMarks;
+	TArray<int> LineMarks;
+	int Stamp = 0;
+	TArray<LightLinkEntry> Queue;
+	TArray<FSection *> Sections;
+	TArray<side_t *> Sides;
+
+	void Begin(FLevelLocals *Level)
+	{
+		if (SectionMarks.Size() != Level->sections.allSections.Size() || LineMarks.Size() != Level->lines.Size())
+		{
+			SectionMarks.Resize(Level->sections.allSections.Size());
+			LineMarks.Resize(Level->lines.Size());
+			memset(SectionMarks.Data(), 0, SectionMarks.Size() * sizeof(int));
+			memset(LineMarks.Data(), 0, LineMarks.Size() * sizeof(int));
+			Stamp = 0;
+		}
+		Stamp++;
+	}
+
+	bool MarkSection(FLevelLocals *Level, FSection *sect)
+	{
+		int &mark = SectionMarks[Level->sections.SectionIndex(sect)];
+		if (mark == Stamp) return false;
+		mark = Stamp;
+		return true;
+	}
+
+	bool IsLineMarked(line_t *line) const
+	{
+		return LineMarks[line->Index()] == Stamp;
+	}
+
+	void MarkLine(line_t *line)
+	{
+		LineMarks[line->Index()] = Stamp;
+	}
+};
+
+struct FLightLinkResult
+{
+	FLightLinkWorker *worker;
+	unsigned firstsection, numsections;
+	unsigned firstside, numsides;
+	bool shadowmapped;
+};
+
+enum
+{
+	MAX_LINKWORKERS = 8,
+	MIN_LIGHTS_PER_WORKER = 16,
+};
+
+static FLightLinkWorker LinkWorkers[MAX_LINKWORKERS];
+static TArray<FLightLinkResult> LinkResults;
+static ctpl::thread_pool LinkPool;	// threads get started on first use and stopped by the destructor on exit
+static cycle_t LinkCycles;
+static int LinkCount;
+
+//==========================================================================
+//
+// Collect all touched sidedefs and subsectors
+// to sidedefs and sector parts.
+//
+//==========================================================================
+void FDynamicLight::CollectWithinRadius(FLightLinkWorker &worker, FLightLinkResult &result, const DVector3 &opos, FSection *section, float radius)
 {
 	if (!section) return;
+	auto &collected_ss = worker.Queue;
 	collected_ss.Clear();
 	collected_ss.Push({ section, opos });
-	section->validcount = dl_validcount;
+	worker.MarkSection(Level, section);
 
 	bool hitonesidedback = false;
 	for (unsigned i = 0; i < collected_ss.Size(); i++)
@@ -546,19 +625,19 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 		auto pos = collected_ss[i].pos;
 		section = collected_ss[i].sect;
 
-		touching_sector = AddLightNode(&section->lighthead, section, this, touching_sector);
+		worker.Sections.Push(section);
 
 
 		auto processSide = [&](side_t *sidedef, const vertex_t *v1, const vertex_t *v2)
 		{
 			auto linedef = sidedef->linedef;
-			if (linedef && linedef->validcount != ::validcount)
+			if (linedef && !worker.IsLineMarked(linedef))
 			{
 				// light is in front of the seg
 				if ((pos.Y - v1->fY()) * (v2->fX() - v1->fX()) + (v1->fX() - pos.X) * (v2->fY() - v1->fY()) <= 0)
 				{
-					linedef->validcount = ::validcount;
-					touching_sides = AddLightNode(&sidedef->lighthead, sidedef, this, touching_sides);
+					worker.MarkLine(linedef);
+					worker.Sides.Push(sidedef);
 				}
 				else if (linedef->sidedef[0] == sidedef && linedef->sidedef[1] == nullptr)
 				{
@@ -571,13 +650,12 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 				if (port && port->mType == PORTT_LINKED)
 				{
 					line_t *other = port->mDestination;
-					if (other->validcount != ::validcount)
+					if (!worker.IsLineMarked(other))
 					{
 						subsector_t *othersub = Level->PointInRenderSubsector(other->v1->fPos() + other->Delta() / 2);
 						FSection *othersect = othersub->section;
-						if (othersect->validcount != ::validcount)
+						if (worker.MarkSection(Level, othersect))
 						{
-							othersect->validcount = ::validcount;
 							collected_ss.Push({ othersect, PosRelative(other->frontsector->PortalGroup) });
 						}
 					}
@@ -601,9 +679,8 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 				if (partner)
 				{
 					FSection *sect = partner->section;
-					if (sect != nullptr && sect->validcount != dl_validcount)
+					if (sect != nullptr && worker.MarkSection(Level, sect))
 					{
-						sect->validcount = dl_validcount;
 						collected_ss.Push({ sect, pos });
 					}
 				}
@@ -626,9 +703,8 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 				DVector2 refpos = other->v1->fPos() + other->Delta() / 2 + sec->GetPortalDisplacement(sector_t::ceiling);
 				subsector_t *othersub = Level->PointInRenderSubsector(refpos);
 				FSection *othersect = othersub->section;
-				if (othersect->validcount != dl_validcount)
+				if (worker.MarkSection(Level, othersect))
 				{
-					othersect->validcount = dl_validcount;
 					collected_ss.Push({ othersect, PosRelative(othersub->sector->PortalGroup) });
 				}
 			}
@@ -641,24 +717,48 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 				DVector2 refpos = other->v1->fPos() + other->Delta() / 2 + sec->GetPortalDisplacement(sector_t::floor);
 				subsector_t *othersub = Level->PointInRenderSubsector(refpos);
 				FSection *othersect = othersub->section;
-				if (othersect->validcount != dl_validcount)
+				if (worker.MarkSection(Level, othersect))
 				{
-					othersect->validcount = dl_validcount;
 					collected_ss.Push({ othersect, PosRelative(othersub->sector->PortalGroup) });
 				}
 			}
 		}
 	}
-	shadowmapped = hitonesidedback && !DontShadowmap();
+	result.shadowmapped = hitonesidedback;
 }
 
 //==========================================================================
 //
-// Link the light into the world
+// Collects everything the light touches into the worker's buffers.
 //
 //==========================================================================
 
-void FDynamicLight::LinkLight()
+void FDynamicLight::CollectLinks(FLightLinkWorker &worker, FLightLinkResult &result)
+{
+	result.worker = &worker;
+	result.firstsection = worker.Sections.Size();
+	result.firstside = worker.Sides.Size();
+	result.shadowmapped = false;
+
+	if (radius>0)
+	{
+		// passing in radius*radius allows us to do a distance check without any calls to sqrt
+		FSection *sect = Level->PointInRenderSubsector(Pos)->section;
+
+		worker.Begin(Level);
+		CollectWithinRadius(worker, result, Pos, sect, float(radius*radius));
+	}
+	result.numsections = worker.Sections.Size() - result.firstsection;
+	result.numsides = worker.Sides.Size() - result.firstside;
+}
+
+//==========================================================================
+//
+// Replaces the light's nodes with the collected ones.
+//
+//==========================================================================
+
+void FDynamicLight::ApplyLinks(const FLightLinkResult &result)
 {
 	// mark the old light nodes
 	FLightNode * node;
@@ -676,16 +776,18 @@ void FDynamicLight::LinkLight()
 		node = node->nextTarget;
 	}
 
-	if (radius>0)
+	auto &worker = *result.worker;
+	for (unsigned i = 0; i < result.numsections; i++)
 	{
-		// passing in radius*radius allows us to do a distance check without any calls to sqrt
-		FSection *sect = Level->PointInRenderSubsector(Pos)->section;
-
-		dl_validcount++;
-		::validcount++;
-		CollectWithinRadius(Pos, sect, float(radius*radius));
-
+		FSection *section = worker.Sections[result.firstsection + i];
+		touching_sector = AddLightNode(&section->lighthead, section, this, touching_sector);
+	}
+	for (unsigned i = 0; i < result.numsides; i++)
+	{
+		side_t *sidedef = worker.Sides[result.firstside + i];
+		touching_sides = AddLightNode(&sidedef->lighthead, sidedef, this, touching_sides);
 	}
+	shadowmapped = result.shadowmapped && !DontShadowmap();
 		
 	// Now delete any nodes that won't be used. These are the ones where
 	// m_thing is still nullptr.
@@ -713,6 +815,112 @@ void FDynamicLight::LinkLight()
 	}
 }
 
+//==========================================================================
+//
+// Link the light into the world
+//
+//==========================================================================
+
+void FDynamicLight::LinkLight()
+{
+	FLightLinkResult result;
+	auto &worker = LinkWorkers[0];
+	worker.Sections.Clear();
+	worker.Sides.Clear();
+	CollectLinks(worker, result);
+	ApplyLinks(result);
+}
+
+//==========================================================================
+//
+// Defers linking until all thinkers have run, so that a light moving
+// several times in one tic gets linked once and all lights moved in a tic
+// can be collected in parallel.
+//
+//==========================================================================
+
+void FDynamicLight::QueueLink()
+{
+	if (!linkpending)
+	{
+		linkpending = true;
+		PendingLinks.Push(this);
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FDynamicLight::LinkPendingLights()
+{
+	if (PendingLinks.Size() == 0) return;
+
+	LinkCycles.Reset();
+	LinkCycles.Clock();
+
+	unsigned count = PendingLinks.Size();
+	LinkCount = count;
+	LinkResults.Resize(count);
+
+	unsigned numworkers = clamp<unsigned>(count / MIN_LIGHTS_PER_WORKER, 1, MAX_LINKWORKERS);
+	if (numworkers > 1)
+	{
+		// No point in more threads than cores. The main thread works on the first share itself.
+		numworkers = min<unsigned>(numworkers, max(std::thread::hardware_concurrency(), 1u));
+	}
+
+	auto collect = [=](unsigned w)
+	{
+		auto &worker = LinkWorkers[w];
+		worker.Sections.Clear();
+		worker.Sides.Clear();
+		// Interleave the lights so that every worker gets some of the big ones.
+		for (unsigned i = w; i < count; i += numworkers)
+		{
+			if (PendingLinks[i] != nullptr) PendingLinks[i]->CollectLinks(worker, LinkResults[i]);
+		}
+	};
+
+	if (numworkers > 1)
+	{
+		if (LinkPool.size() == 0) LinkPool.resize(MAX_LINKWORKERS - 1);
+
+		std::future<void> futures[MAX_LINKWORKERS];
+		for (unsigned w = 1; w < numworkers; w++)
+		{
+			futures[w] = LinkPool.push([=](int id) { collect(w); });
+		}
+		collect(0);
+		for (unsigned w = 1; w < numworkers; w++)
+		{
+			futures[w].wait();
+		}
+	}
+	else collect(0);
+
+	// Apply in the order the lights were queued, so the node lists come out the same regardless of the worker count.
+	for (unsigned i = 0; i < count; i++)
+	{
+		auto light = PendingLinks[i];
+		if (light != nullptr)
+		{
+			light->linkpending = false;
+			light->ApplyLinks(LinkResults[i]);
+		}
+	}
+	PendingLinks.Clear();
+	LinkCycles.Unclock();
+}
+
+ADD_STAT(lightlinks)
+{
+	FString out;
+	out.Format("Last batch: link time = %04.2f ms - %d lights", LinkCycles.TimeMS(), LinkCount);
+	return out;
+}
 
 //==========================================================================
 //
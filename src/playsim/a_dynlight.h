@@ -195,6 +195,9 @@ struct FLightNode
 	};
 };
 
+struct FLightLinkWorker;
+struct FLightLinkResult;
+
 struct FDynamicLight
 {
 	friend class FLightDefaults;
@@ -246,12 +249,16 @@ struct FDynamicLight
 	void Tick();
 	void UpdateLocation();
 	void LinkLight();
+	void QueueLink();
 	void UnlinkLight();
 	void ReleaseLight();
+	static void LinkPendingLights();
 
 private:
 	double DistToSeg(const DVector3 &pos, vertex_t *start, vertex_t *end);
-	void CollectWithinRadius(const DVector3 &pos, FSection *section, float radius);
+	void CollectWithinRadius(FLightLinkWorker &worker, FLightLinkResult &result, const DVector3 &pos, FSection *section, float radius);
+	void CollectLinks(FLightLinkWorker &worker, FLightLinkResult &result);
+	void ApplyLinks(const FLightLinkResult &result);
 
 public:
 	FCycler m_cycler;
@@ -281,6 +288,7 @@ public:
 	bool m_active;
 	bool visibletoplayer;
 	bool shadowmapped;
+	bool linkpending;		// queued for LinkPendingLights
 	uint8_t lighttype;
 	bool owned;
 	bool swapped;
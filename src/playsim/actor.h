@@ -660,6 +660,15 @@ struct FLinkContext
 	msecnode_t *render_list = nullptr;
 };
 
+// Area around an actor's position that was found to contain no lines.
+// As long as the actor's box stays inside it its sector list cannot change.
+struct FSecNodeCache
+{
+	DVector2 Center;
+	double HalfSize;
+	int Generation;		// 0 means invalid
+};
+
 struct FDropItem
 {
 	FDropItem *Next;
@@ -738,6 +747,7 @@ public:
 	virtual void PostSerialize() override;
 	virtual void PostBeginPlay() override;		// Called immediately before the actor's first tick
 	virtual void Tick() override;
+	virtual bool IsAsleep() override;
 
 	static AActor *StaticSpawn (FLevelLocals *Level, PClassActor *type, const DVector3 &pos, replace_t allowreplacement, bool SpawningMapThing = false);
 
@@ -1028,14 +1038,56 @@ public:
 	void AttachLight(unsigned int count, const FLightDefaults *lightdef);
 	void SetDynamicLights();
 
-// info for drawing
 // NOTE: The first member variable *must* be snext.
 	AActor			*snext, **sprev;	// links in sector (if needed)
 	DVector3		__Pos;		// double underscores so that it won't get used by accident. Access to this should be exclusively through the designated access functions.
 
+// Everything the movement code and the tick loop use for every actor, kept together
+// so that ticking many actors touches as few cache lines as possible.
+	DVector3		Vel;
+	DRotator		Angles;
+	ActorFlags		flags;
+	ActorFlags2		flags2;			// Heretic flags
+	ActorFlags3		flags3;			// [RH] Hexen/Heretic actor-dependant behavior made flaggable
+	ActorFlags4		flags4;			// [RH] Even more flags!
+	ActorFlags5		flags5;			// OMG! We need another one.
+	ActorFlags6		flags6;			// Shit! Where did all the flags go?
+	ActorFlags7		flags7;			// WHO WANTS TO BET ON 8!?
+	ActorFlags8		flags8;			// I see your 8, and raise you a bet for 9.
+	double			radius, Height;		// for movement checking
+	double			Floorclip;		// value to use for floor clipping
+	double			Speed;
+	double			FloatSpeed;
+	double			Gravity;		// [GRB] Gravity factor
+	double			Friction;
+	double			MaxDropOffHeight;
+	double			MaxStepHeight;
+	FBlockNode		*BlockNode;			// links in blocks (if needed)
+	struct sector_t	*Sector;
+	subsector_t *		subsector;
+	FSection *			section;
+	double			floorz, ceilingz;	// closest together of contacted secs
+	double			dropoffz;		// killough 11/98: the lowest floor over all contacted Sectors.
+	uint32_t		ThruBits;
+	FTextureID		floorpic;			// contacted sec floorpic
+	int				floorterrain;
+	FTextureID		ceilingpic;			// contacted sec ceilingpic
+	struct sector_t	*floorsector;
+	struct sector_t	*ceilingsector;
+	int32_t			tics;				// state tic counter
+	FState			*state;
+	uint32_t		freezetics;	// actor has actions completely frozen (including movement) for this many tics, but they still get Tick() calls
+	int 			health;
+	player_t		*player;		// only valid if type of PlayerPawn
+	int				waterlevel;		// 0=none, 1=feet, 2=waist, 3=eyes
+	ActorBounceFlags	BounceFlags;	// which bouncing type?
+	uint8_t			movedir;		// 0-7
+	int8_t			visdir;
+	int16_t			movecount;		// when 0, select a new dir
+
+// info for drawing
 	DAngle			SpriteAngle;
 	DAngle			SpriteRotation;
-	DRotator		Angles;
 	DRotator		ViewAngles;			// Angle offsets for cameras
 	TObjPtr<DViewPosition*> ViewPos;			// Position offsets for cameras
 	DVector2		Scale;				// Scaling values; 1 is normal size
@@ -1055,16 +1107,6 @@ public:
 
 	ActorRenderFlags	renderflags;		// Different rendering flags
 	ActorRenderFlags2	renderflags2;		// More rendering flags...
-	ActorFlags		flags;
-	ActorFlags2		flags2;			// Heretic flags
-	ActorFlags3		flags3;			// [RH] Hexen/Heretic actor-dependant behavior made flaggable
-	ActorFlags4		flags4;			// [RH] Even more flags!
-	ActorFlags5		flags5;			// OMG! We need another one.
-	ActorFlags6		flags6;			// Shit! Where did all the flags go?
-	ActorFlags7		flags7;			// WHO WANTS TO BET ON 8!?
-	ActorFlags8		flags8;			// I see your 8, and raise you a bet for 9.
-	double			Floorclip;		// value to use for floor clipping
-	double			radius, Height;		// for movement checking
 
 	FAngle			VisibleStartAngle;
 	FAngle			VisibleStartPitch;
@@ -1072,29 +1114,11 @@ public:
 	FAngle			VisibleEndPitch;
 
 	DVector3		OldRenderPos;
-	DVector3		Vel;
 	DVector2		SpriteOffset;
 	DVector3		WorldOffset;
-	double			Speed;
-	double			FloatSpeed;
 	TObjPtr<DActorModelData*>		modelData;
 	TObjPtr<DBoneComponents*>		boneComponentData;
 
-// interaction info
-	FBlockNode		*BlockNode;			// links in blocks (if needed)
-	struct sector_t	*Sector;
-	subsector_t *		subsector;
-	FSection *			section;
-	double			floorz, ceilingz;	// closest together of contacted secs
-	double			dropoffz;		// killough 11/98: the lowest floor over all contacted Sectors.
-
-	uint32_t		ThruBits;
-	FTextureID		floorpic;			// contacted sec floorpic
-	int				floorterrain;
-	FTextureID		ceilingpic;			// contacted sec ceilingpic
-
-	struct sector_t	*floorsector;
-	struct sector_t	*ceilingsector;
 	double			renderradius;
 
 	double			projectilepassheight;	// height for clipping projectile movement against this actor
@@ -1106,8 +1130,6 @@ public:
 	double			StealthAlpha;	// Minmum alpha for MF_STEALTH.
 	int				WoundHealth;		// Health needed to enter wound state
 
-	int32_t			tics;				// state tic counter
-	FState			*state;
 	//VMFunction		*Damage;			// For missiles and monster railgun
 	int				DamageVal;
 	int				projectileKickback;
@@ -1122,15 +1144,11 @@ public:
 
 	uint32_t			VisibleToTeam;
 	int				weaponspecial;	// Special info for weapons.
-	int 			health;
 	int32_t			reactiontime;	// if non 0, don't attack yet; used by
 									// player to freeze a bit after teleporting
 	int32_t			threshold;		// if > 0, the target will be chased
 	int32_t			DefThreshold;	// [MC] Default threshold which the actor will reset its threshold to after switching targets
 
-	uint8_t			movedir;		// 0-7
-	int8_t			visdir;
-	int16_t			movecount;		// when 0, select a new dir
 
 	int16_t			strafecount;	// for MF3_AVOIDMELEE
 	int16_t			LightLevel;		// Allows for overriding sector light levels.
@@ -1141,7 +1159,6 @@ public:
 	TObjPtr<AActor*>	lastenemy;		// Last known enemy -- killough 2/15/98
 	TObjPtr<AActor*> LastHeard;		// [RH] Last actor this one heard
 									// no matter what (even if shot)
-	player_t		*player;		// only valid if type of PlayerPawn
 	TObjPtr<AActor*>	LastLookActor;	// Actor last looked for (if TIDtoHate != 0)
 	DVector3		SpawnPoint; 	// For nightmare respawn
 	int				StartHealth;
@@ -1162,12 +1179,10 @@ public:
 
 	AActor			*inext, **iprev;// Links to other mobjs in same bucket
 	TObjPtr<AActor*> goal;			// Monster's goal if not chasing anything
-	int				waterlevel;		// 0=none, 1=feet, 2=waist, 3=eyes
 	double			waterdepth;		// Stores how deep into water you are, in map units
 	uint8_t			boomwaterlevel;	// splash information for non-swimmable water sectors
 	uint8_t			MinMissileChance;// [RH] If a random # is > than this, then missile attack.
 	int8_t			LastLookPlayerNumber;// Player number last looked for (if TIDtoHate == 0)
-	ActorBounceFlags	BounceFlags;	// which bouncing type?
 	uint32_t			SpawnFlags;		// Increased to uint32_t because of Doom 64
 	double			meleerange;		// specifies how far a melee attack reaches.
 	double			meleethreshold;	// Distance below which a monster doesn't try to shoot missiles anynore
@@ -1176,8 +1191,6 @@ public:
 	double			maxtargetrange;	// any target farther away cannot be attacked
 	double			bouncefactor;	// Strife's grenades use 50%, Hexen's Flechettes 70.
 	double			wallbouncefactor;	// The bounce factor for walls can be different.
-	double			Gravity;		// [GRB] Gravity factor
-	double			Friction;
 	double			pushfactor;
 	int				bouncecount;	// Strife's grenades only bounce twice before exploding
 	int 			FastChaseStrafeCount;
@@ -1195,7 +1208,6 @@ public:
 	sector_t		*BlockingCeiling;	// Sector that blocked the last move (ceiling plane slope)
 	sector_t		*BlockingFloor;		// Sector that blocked the last move (floor plane slope)
 
-	uint32_t		freezetics;	// actor has actions completely frozen (including movement) for this many tics, but they still get Tick() calls
 
 	int PoisonDamage; // Damage received per tic from poison.
 	FName PoisonDamageType; // Damage type dealt by poison.
@@ -1213,7 +1225,10 @@ public:
 	struct msecnode_t	*touching_sectorportallist;		// same for cross-sectorportal rendering
 	struct portnode_t	*touching_lineportallist;		// and for cross-lineportal
 	struct msecnode_t	*touching_rendersectors; // this is the list of sectors that this thing interesects with it's max(radius, renderradius).
+	FSecNodeCache SectorListCache, RenderListCache;	// not serialized, they get rebuilt on the first move.
 	int validcount;
+	int spritecullcount;	// validcount of the hardware renderer's last visibility precheck
+	bool spriteculled;
 
 
 	TObjPtr<AActor*>	Inventory;		// [RH] This actor's inventory
@@ -1237,8 +1252,6 @@ public:
 	FSoundIDNoInit WallBounceSound;
 	FSoundIDNoInit CrushPainSound;
 
-	double MaxDropOffHeight;
-	double MaxStepHeight;
 	double MaxSlopeSteepness;
 
 	int32_t Mass;
@@ -47,11 +47,16 @@
 #include "d_main.h"
 
 static int ThinkCount;
+static int SleepCount;
 static cycle_t ThinkCycles;
 extern cycle_t BotSupportCycles;
 extern cycle_t ActionCycles;
 extern int BotWTG;
 
+// Lets thinkers whose Tick would be a no-op skip it. Turning it off is only
+// useful to compare 'stat think' timings, the game state is the same either way.
+CVAR(Bool, sv_thinkersleep, true, 0)
+
 IMPLEMENT_CLASS(DThinker, false, false)
 
 struct ProfileInfo
@@ -101,6 +106,7 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 	int i, count;
 
 	ThinkCount = 0;
+	SleepCount = 0;
 	ThinkCycles.Reset();
 	BotSupportCycles.Reset();
 	ActionCycles.Reset();
@@ -167,6 +173,7 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 				light = next;
 			}
 		}
+		FDynamicLight::LinkPendingLights();
 	}
 	else
 	{
@@ -202,6 +209,7 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 			}
 			prof.timer.Unclock();
 		}
+		FDynamicLight::LinkPendingLights();
 
 
 		struct SortedProfileInfo
@@ -401,6 +409,48 @@ void FThinkerList::AddTail(DThinker *thinker)
 	GC::WriteBarrier(thinker, Sentinel);
 	GC::WriteBarrier(tail, thinker);
 	GC::WriteBarrier(Sentinel, thinker);
+
+	thinker->OwnerList = this;
+	if (NextOrder == UINT32_MAX) Renumber();
+	thinker->ListOrder = NextOrder++;
+	LinkClass(thinker);
+}
+
+//==========================================================================
+//
+// Class chain maintenance
+//
+//==========================================================================
+
+void FThinkerList::LinkClass(DThinker *thinker)
+{
+	auto &chain = ClassChains[thinker->GetClass()];
+	thinker->PrevOfClass = chain.Tail;
+	thinker->NextOfClass = nullptr;
+	if (chain.Tail != nullptr) chain.Tail->NextOfClass = thinker;
+	else chain.Head = thinker;
+	chain.Tail = thinker;
+}
+
+void FThinkerList::UnlinkClass(DThinker *thinker)
+{
+	auto chain = ClassChains.CheckKey(thinker->GetClass());
+	assert(chain != nullptr);
+	if (thinker->PrevOfClass != nullptr) thinker->PrevOfClass->NextOfClass = thinker->NextOfClass;
+	else chain->Head = thinker->NextOfClass;
+	if (thinker->NextOfClass != nullptr) thinker->NextOfClass->PrevOfClass = thinker->PrevOfClass;
+	else chain->Tail = thinker->PrevOfClass;
+	thinker->NextOfClass = thinker->PrevOfClass = nullptr;
+}
+
+// Only needed if a list ever gets 4 billion additions.
+void FThinkerList::Renumber()
+{
+	NextOrder = 0;
+	for (DThinker *node = Sentinel->NextThinker; node != Sentinel; node = node->NextThinker)
+	{
+		node->ListOrder = NextOrder++;
+	}
 }
 
 //==========================================================================
@@ -522,11 +572,15 @@ bool FThinkerList::DoDestroyThinkers()
 			auto next = node->NextThinker;
 			toDelete.Push(node);
 			node->NextThinker = node->PrevThinker = nullptr;	// clear the links
+			node->NextOfClass = node->PrevOfClass = nullptr;
+			node->OwnerList = nullptr;
 			node = next;
 		}
 		Sentinel->NextThinker = Sentinel->PrevThinker = nullptr;
 		Sentinel->Destroy();
 		Sentinel = nullptr;
+		ClassChains.Clear();
+		NextOrder = 0;
 		for (auto node : toDelete)
 		{
 			// We must intercept all exceptions so that we can continue deleting the list.
@@ -614,9 +668,16 @@ int FThinkerList::TickThinkers(FThinkerList *dest)
 
 		if (!(node->ObjectFlags & OF_EuthanizeMe))
 		{ // Only tick thinkers not scheduled for destruction
-			ThinkCount++;
-			node->CallTick();
-			node->ObjectFlags &= ~OF_JustSpawned;
+			if (dest == nullptr && sv_thinkersleep && node->IsAsleep())
+			{
+				SleepCount++;
+			}
+			else
+			{
+				ThinkCount++;
+				node->CallTick();
+				node->ObjectFlags &= ~OF_JustSpawned;
+			}
 		}
 		node = NextToThink;
 	}
@@ -659,6 +720,12 @@ int FThinkerList::ProfileThinkers(FThinkerList *dest)
 
 		if (!(node->ObjectFlags & OF_EuthanizeMe))
 		{ // Only tick thinkers not scheduled for destruction
+			if (dest == nullptr && sv_thinkersleep && node->IsAsleep())
+			{
+				SleepCount++;
+				node = NextToThink;
+				continue;
+			}
 			ThinkCount++;
 
 			auto &prof = Profiles[node->GetClass()->TypeName];
@@ -727,6 +794,11 @@ void DThinker::Remove()
 	GC::WriteBarrier(next, prev);
 	NextThinker = nullptr;
 	PrevThinker = nullptr;
+	if (OwnerList != nullptr)
+	{
+		OwnerList->UnlinkClass(this);
+		OwnerList = nullptr;
+	}
 }
 
 //==========================================================================
@@ -884,6 +956,18 @@ DEFINE_ACTION_FUNCTION(DThinker, Tick)
 	return 0;
 }
 
+//==========================================================================
+//
+// Plain thinkers have no way of telling whether their Tick would do
+// anything, so they are always considered awake.
+//
+//==========================================================================
+
+bool DThinker::IsAsleep()
+{
+	return false;
+}
+
 void DThinker::CallTick()
 {
 	IFVIRTUAL(DThinker, Tick)
@@ -961,7 +1045,10 @@ FThinkerIterator::FThinkerIterator (FLevelLocals *l, const PClass *type, int sta
 	}
 	else
 	{
+		m_CurrList = &Level->Thinkers.Thinkers[m_Stat];
 		m_CurrThinker = prev->NextThinker;
+		m_LastReturned = nullptr;
+		m_CursorState = CURSORS_None;
 		m_SearchingFresh = false;
 	}
 }
@@ -974,7 +1061,7 @@ FThinkerIterator::FThinkerIterator (FLevelLocals *l, const PClass *type, int sta
 
 void FThinkerIterator::Reinit ()
 {
-	m_CurrThinker = Level->Thinkers.Thinkers[m_Stat].GetHead();
+	StartList(&Level->Thinkers.Thinkers[m_Stat]);
 	m_SearchingFresh = false;
 }
 
@@ -984,6 +1071,155 @@ void FThinkerIterator::Reinit ()
 //
 //==========================================================================
 
+void FThinkerIterator::StartList(FThinkerList *list)
+{
+	m_CurrList = list;
+	m_CurrThinker = list->GetHead();
+	m_LastReturned = nullptr;
+	m_CursorState = CURSORS_Unset;
+}
+
+//==========================================================================
+//
+// Adds a cursor for each matching class chain in the current list that
+// doesn't have one yet. Returns false if there are too many of them.
+//
+//==========================================================================
+
+bool FThinkerIterator::AddCursors(bool exact)
+{
+	decltype(m_CurrList->ClassChains)::ConstIterator it(m_CurrList->ClassChains);
+	decltype(m_CurrList->ClassChains)::ConstPair *pair;
+
+	while (it.NextPair(pair))
+	{
+		auto type = pair->Key;
+		if (exact ? type != m_ParentType : !type->IsDescendantOf(m_ParentType)) continue;
+
+		bool known = false;
+		for (int i = 0; i < m_NumCursors && !known; i++)
+		{
+			known = m_Cursors[i].Type == type;
+		}
+		if (known) continue;
+		if (m_NumCursors == MAX_CURSORS) return false;
+		m_Cursors[m_NumCursors++] = { type, nullptr, nullptr };
+	}
+	m_ChainCount = m_CurrList->ClassChains.CountUsed();
+	return true;
+}
+
+//==========================================================================
+//
+// Continues with a plain scan of the current list after the last thinker
+// the cursors returned.
+//
+//==========================================================================
+
+void FThinkerIterator::StopCursors()
+{
+	m_CursorState = CURSORS_None;
+	if (m_LastReturned == nullptr) m_CurrThinker = m_CurrList->GetHead();
+	else if (m_LastReturned->OwnerList == m_CurrList) m_CurrThinker = m_LastReturned->NextThinker;
+	else m_CurrThinker = nullptr;
+}
+
+//==========================================================================
+//
+// Returns the next matching thinker of the current list. The class chains
+// are used if only a few classes in the list match, otherwise the list
+// gets scanned. Either way the thinkers are returned in list order.
+//
+//==========================================================================
+
+DThinker *FThinkerIterator::NextInList(bool exact)
+{
+	if (m_CursorState == CURSORS_Unset)
+	{
+		m_CursorState = CURSORS_None;
+		if (m_CurrThinker != nullptr)
+		{
+			m_NumCursors = 0;
+			m_CursorsExact = exact;
+			if (AddCursors(exact)) m_CursorState = CURSORS_Active;
+		}
+	}
+	if (m_CursorState == CURSORS_Active)
+	{
+		if (exact == m_CursorsExact) return NextFromCursors(exact);
+		StopCursors();
+	}
+
+	if (m_CurrThinker != nullptr)
+	{
+		while (!(m_CurrThinker->ObjectFlags & OF_Sentinel))
+		{
+			DThinker *thinker = m_CurrThinker;
+			m_CurrThinker = thinker->NextThinker;
+			if (exact)
+			{
+				if (thinker->IsA(m_ParentType)) return thinker;
+			}
+			else if (thinker->IsKindOf(m_ParentType))
+			{
+				return thinker;
+			}
+			// This can actually happen when a Destroy call on 'thinker' happens to destroy 'm_CurrThinker'.
+			// In that case there is no chance to recover, we have to terminate the iteration of this list.
+			if (m_CurrThinker == nullptr) break;
+		}
+	}
+	return nullptr;
+}
+
+//==========================================================================
+//
+// Merges the class chains by list order.
+//
+//==========================================================================
+
+DThinker *FThinkerIterator::NextFromCursors(bool exact)
+{
+	// Classes that got their first thinker in this list since the last call.
+	if (m_CurrList->ClassChains.CountUsed() != m_ChainCount && !AddCursors(exact))
+	{
+		StopCursors();
+		return NextInList(exact);
+	}
+
+	DThinker *best = nullptr;
+	int bestindex = -1;
+	for (int i = 0; i < m_NumCursors; i++)
+	{
+		auto &cursor = m_Cursors[i];
+		DThinker *next;
+
+		if (cursor.Last == nullptr) next = m_CurrList->GetClassHead(cursor.Type);
+		else if (cursor.Last->OwnerList == m_CurrList) next = cursor.Last->NextOfClass;
+		else if (cursor.Next != nullptr && cursor.Next->OwnerList == m_CurrList) next = cursor.Next;	// the last one was removed from the list.
+		else next = nullptr;
+
+		if (next != nullptr && (best == nullptr || next->ListOrder < best->ListOrder))
+		{
+			best = next;
+			bestindex = i;
+		}
+	}
+	if (best != nullptr)
+	{
+		m_Cursors[bestindex].Last = best;
+		m_Cursors[bestindex].Next = best->NextOfClass;
+		m_LastReturned = best;
+	}
+	return best;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
 DThinker *FThinkerIterator::Next (bool exact)
 {
 	if (m_ParentType == nullptr)
@@ -994,28 +1230,14 @@ DThinker *FThinkerIterator::Next (bool exact)
 	{
 		do
 		{
-			if (m_CurrThinker != nullptr)
+			DThinker *thinker = NextInList(exact);
+			if (thinker != nullptr)
 			{
-				while (!(m_CurrThinker->ObjectFlags & OF_Sentinel))
-				{
-					DThinker *thinker = m_CurrThinker;
-					m_CurrThinker = thinker->NextThinker;
-					if (exact)
-					{
-						if (thinker->IsA(m_ParentType)) return thinker;
-					}
-					else if (thinker->IsKindOf(m_ParentType))
-					{
-						return thinker;
-					}
-					// This can actually happen when a Destroy call on 'thinker' happens to destroy 'm_CurrThinker'.
-					// In that case there is no chance to recover, we have to terminate the iteration of this list.
-					if (m_CurrThinker == nullptr) break;
-				}
+				return thinker;
 			}
 			if ((m_SearchingFresh = !m_SearchingFresh))
 			{
-				m_CurrThinker = Level->Thinkers.FreshThinkers[m_Stat].GetHead();
+				StartList(&Level->Thinkers.FreshThinkers[m_Stat]);
 			}
 		} while (m_SearchingFresh);
 		if (m_SearchStats)
@@ -1026,7 +1248,7 @@ DThinker *FThinkerIterator::Next (bool exact)
 				m_Stat = STAT_FIRST_THINKING;
 			}
 		}
-		m_CurrThinker = Level->Thinkers.Thinkers[m_Stat].GetHead();
+		StartList(&Level->Thinkers.Thinkers[m_Stat]);
 		m_SearchingFresh = false;
 	} while (m_SearchStats && m_Stat != STAT_FIRST_THINKING);
 	return nullptr;
@@ -1041,6 +1263,7 @@ DThinker *FThinkerIterator::Next (bool exact)
 ADD_STAT (think)
 {
 	FString out;
-	out.Format ("Think time = %04.2f ms - %d thinkers, Action = %04.2f ms", ThinkCycles.TimeMS(), ThinkCount, ActionCycles.TimeMS());
+	out.Format ("Think time = %04.2f ms - %d thinkers (%.2f us each), %d sleeping, Action = %04.2f ms", ThinkCycles.TimeMS(), ThinkCount,
+		ThinkCount > 0 ? ThinkCycles.TimeMS() * 1000. / ThinkCount : 0., SleepCount, ActionCycles.TimeMS());
 	return out;
 }
@@ -65,9 +65,30 @@ struct FThinkerList
 	void SaveList(FSerializer &arc);
 
 private:
+	// Per class sub-lists in list order, so that class filtered iteration
+	// does not need to look at unrelated thinkers.
+	struct FClassChain
+	{
+		DThinker *Head = nullptr;
+		DThinker *Tail = nullptr;
+	};
+
+	void LinkClass(DThinker *thinker);
+	void UnlinkClass(DThinker *thinker);
+	void Renumber();
+	DThinker *GetClassHead(const PClass *type) const
+	{
+		auto chain = ClassChains.CheckKey(type);
+		return chain == nullptr ? nullptr : chain->Head;
+	}
+
 	DThinker *Sentinel = nullptr;
+	TMap<const PClass *, FClassChain> ClassChains;
+	uint32_t NextOrder = 0;
 
 	friend struct FThinkerCollection;
+	friend class FThinkerIterator;
+	friend class DThinker;
 };
 
 struct FThinkerCollection
@@ -100,6 +121,7 @@ public:
 	void OnDestroy () override;
 	virtual ~DThinker ();
 	virtual void Tick ();
+	virtual bool IsAsleep ();	// True if ticking this thinker now would change nothing
 	void CallTick();
 	virtual void PostBeginPlay ();	// Called just before the first tick
 	virtual void CallPostBeginPlay(); // different in actor.
@@ -119,6 +141,9 @@ private:
 	friend class FDoomSerializer;
 
 	DThinker *NextThinker = nullptr, *PrevThinker = nullptr;
+	DThinker *NextOfClass = nullptr, *PrevOfClass = nullptr;
+	FThinkerList *OwnerList = nullptr;
+	uint32_t ListOrder = 0;		// increases from head to tail within OwnerList
 
 public:
 	FLevelLocals *Level;
@@ -131,11 +156,43 @@ class FThinkerIterator
 protected:
 	const PClass *m_ParentType;
 private:
+	enum
+	{
+		MAX_CURSORS = 8,	// more matching classes than this in a list and a plain scan is faster.
+	};
+
+	enum ECursorState : uint8_t
+	{
+		CURSORS_Unset,		// decided on the first call to Next for the current list
+		CURSORS_None,		// walk the entire list
+		CURSORS_Active,		// merge the class chains of the matching classes
+	};
+
+	struct FClassCursor
+	{
+		const PClass *Type;
+		DThinker *Last;		// last thinker returned from this chain
+		DThinker *Next;		// the one after it at that time
+	};
+
 	FLevelLocals *Level;
+	FThinkerList *m_CurrList;
 	DThinker *m_CurrThinker;
+	DThinker *m_LastReturned;
 	uint8_t m_Stat;
 	bool m_SearchStats;
 	bool m_SearchingFresh;
+	bool m_CursorsExact;
+	ECursorState m_CursorState;
+	int m_NumCursors;
+	unsigned m_ChainCount;
+	FClassCursor m_Cursors[MAX_CURSORS];
+
+	void StartList(FThinkerList *list);
+	bool AddCursors(bool exact);
+	void StopCursors();
+	DThinker *NextInList(bool exact);
+	DThinker *NextFromCursors(bool exact);
 
 public:
 	FThinkerIterator (FLevelLocals *Level, const PClass *type, int statnum=MAX_STATNUM+1);
@@ -1360,13 +1360,13 @@ int P_LookForMonsters (AActor *actor)
 AActor *LookForTIDInBlock (AActor *lookee, int index, void *extparams)
 {
 	FLookExParams *params = (FLookExParams *)extparams;
-	FBlockNode *block;
 	AActor *link;
 	AActor *other;
+	auto &things = lookee->Level->blockmap.blockthings[index];
 	
-	for (block = lookee->Level->blockmap.blocklinks[index]; block != NULL; block = block->NextActor)
+	for (unsigned i = things.Size(); i-- > 0; )
 	{
-		link = block->Me;
+		link = things[i].Me;
 
         if (!(link->flags & MF_SHOOTABLE))
 			continue;			// not shootable (observer or dead)
@@ -1530,14 +1530,14 @@ int P_LookForTID (AActor *actor, INTBOOL allaround, FLookExParams *params)
 
 AActor *LookForEnemiesInBlock (AActor *lookee, int index, void *extparam)
 {
-	FBlockNode *block;
 	AActor *link;
 	AActor *other;
 	FLookExParams *params = (FLookExParams *)extparam;
+	auto &things = lookee->Level->blockmap.blockthings[index];
 	
-	for (block = lookee->Level->blockmap.blocklinks[index]; block != NULL; block = block->NextActor)
+	for (unsigned i = things.Size(); i-- > 0; )
 	{
-		link = block->Me;
+		link = things[i].Me;
 
         if (!(link->flags & MF_SHOOTABLE))
 			continue;			// not shootable (observer or dead)
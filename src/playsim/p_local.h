@@ -46,6 +46,7 @@ struct line_t;
 struct sector_t;
 struct msecnode_t;
 struct portnode_t;
+struct FSecNodeCache;
 struct secplane_t;
 struct FCheckPosition;
 struct FTranslatedLineTarget;
@@ -420,7 +421,8 @@ nodetype *P_AddSecnode(linktype *s, AActor *thing, nodetype *nextnode, nodetype
 template<class nodetype, class linktype>
 nodetype* P_DelSecnode(nodetype *, nodetype *linktype::*head);
 
-msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector_list, msecnode_t *sector_t::*seclisthead);
+msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector_list, msecnode_t *sector_t::*seclisthead, FSecNodeCache *cache = nullptr);
+void P_InvalidateSecNodeCaches();
 double	P_GetMoveFactor(const AActor *mo, double *frictionp);	// phares  3/6/98
 double		P_GetFriction(const AActor *mo, double *frictionfactor);
 
@@ -5827,37 +5827,30 @@ CUSTOM_CVAR(Float, splashfactor, 1.f, CVAR_SERVERINFO)
 // Used by anything without OLDRADIUSDMG flag
 //==========================================================================
 
-static double GetRadiusDamage(bool fromaction, AActor *bombspot, AActor *thing, int bombdamage, int bombdistance, int fulldamagedistance, bool thingbombsource)
+static double GetRadiusDamageDistance(const DVector2 &vec, double bombz, double thingz, double thingtop, double boxradius)
 {
 	// [RH] New code. The bounding box only covers the
 	// height of the thing and not the height of the map.
-	double points;
 	double len;
 	double dx, dy;
-	double boxradius;
-
-	double bombdistancefloat = 1. / (double)(bombdistance - fulldamagedistance);
-	double bombdamagefloat = (double)bombdamage;
 
-	DVector2 vec = bombspot->Vec2To(thing);
 	dx = fabs(vec.X);
 	dy = fabs(vec.Y);
-	boxradius = thing->radius;
 
 	// The damage pattern is square, not circular.
 	len = double(dx > dy ? dx : dy);
 
-	if (bombspot->Z() < thing->Z() || bombspot->Z() >= thing->Top())
+	if (bombz < thingz || bombz >= thingtop)
 	{
 		double dz;
 
-		if (bombspot->Z() > thing->Z())
+		if (bombz > thingz)
 		{
-			dz = double(bombspot->Z() - thing->Top());
+			dz = double(bombz - thingtop);
 		}
 		else
 		{
-			dz = double(thing->Z() - bombspot->Z());
+			dz = double(thingz - bombz);
 		}
 		if (len <= boxradius)
 		{
@@ -5875,6 +5868,20 @@ static double GetRadiusDamage(bool fromaction, AActor *bombspot, AActor *thing,
 		if (len < 0.f)
 			len = 0.f;
 	}
+	return len;
+}
+
+static double GetRadiusDamage(bool fromaction, AActor *bombspot, AActor *thing, int bombdamage, int bombdistance, int fulldamagedistance, bool thingbombsource, double len = -1)
+{
+	double points;
+
+	double bombdistancefloat = 1. / (double)(bombdistance - fulldamagedistance);
+	double bombdamagefloat = (double)bombdamage;
+
+	if (len < 0)
+	{
+		len = GetRadiusDamageDistance(bombspot->Vec2To(thing), bombspot->Z(), thing->Z(), thing->Top(), thing->radius);
+	}
 	len = clamp<double>(len - (double)fulldamagedistance, 0, len);
 	points = bombdamagefloat * (1. - len * bombdistancefloat);
 
@@ -5973,6 +5980,29 @@ int P_GetRadiusDamage(AActor *self, AActor *thing, int damage, int distance, int
 	return newdam;
 }
 
+//==========================================================================
+//
+// Candidates of the running radius attacks. The list is shared by all
+// of them so that chains of explosions do not need to allocate anything.
+//
+//==========================================================================
+
+struct FRadiusTarget
+{
+	AActor *thing;
+	DVector3 pos;
+	double radius, height;
+	DVector2 vec;
+	double len;
+
+	bool Matches(AActor *actor, AActor *bombspot, const DVector3 &bombpos) const
+	{
+		return actor->Pos() == pos && actor->radius == radius && actor->Height == height && bombspot->Pos() == bombpos;
+	}
+};
+
+static TArray<FRadiusTarget> RadiusTargets;
+
 //==========================================================================
 //
 // P_RadiusAttack
@@ -5998,7 +6028,8 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bom
 
 	P_GeometryRadiusAttack(bombspot, bombsource, bombdamage, bombdistance, bombmod, fulldamagedistance);
 
-	TArray<AActor*> targets;
+	// Radius attacks can nest through P_DamageMobj, so each call only owns the part of the list behind 'first'.
+	unsigned first = RadiusTargets.Size();
 	int count = 0;
 	while ((it.Next(&cres)))
 	{
@@ -6039,11 +6070,24 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bom
 			continue;
 		}
 
-		targets.Push(thing);
+		RadiusTargets.Push({ thing, thing->Pos(), thing->radius, thing->Height, bombspot->Vec2To(thing), 0 });
 	}
 
-	for (AActor *thing : targets)
+	// Get the distances for all candidates in one go.
+	const DVector3 bombpos = bombspot->Pos();
+	for (unsigned i = first; i < RadiusTargets.Size(); i++)
 	{
+		auto &target = RadiusTargets[i];
+		target.len = GetRadiusDamageDistance(target.vec, bombpos.Z, target.pos.Z, target.pos.Z + target.height, target.radius);
+	}
+
+	const unsigned last = RadiusTargets.Size();
+	for (unsigned i = first; i < last; i++)
+	{
+		AActor *thing = RadiusTargets[i].thing;
+		// Damaging the previous targets may have moved things around, in which case the precalculated distance is useless.
+		double len = RadiusTargets[i].Matches(thing, bombspot, bombpos) ? RadiusTargets[i].len : -1;
+
 		// Barrels always use the original code, since this makes
 		// them far too "active." BossBrains also use the old code
 		// because some user levels require they have a height of 16,
@@ -6051,7 +6095,7 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bom
 		if ((flags & RADF_NODAMAGE) || (!((bombspot->flags5 | thing->flags5) & MF5_OLDRADIUSDMG) && 
 			!(flags & RADF_OLDRADIUSDAMAGE) && !(thing->Level->i_compatflags2 & COMPATF2_EXPLODE2)))
 		{
-			double points = GetRadiusDamage(false, bombspot, thing, bombdamage, bombdistance, fulldamagedistance, bombsource == thing);
+			double points = GetRadiusDamage(false, bombspot, thing, bombdamage, bombdistance, fulldamagedistance, bombsource == thing, len);
 			double check = int(points) * bombdamage;
 			// points and bombdamage should be the same sign (the double cast of 'points' is needed to prevent overflows and incorrect values slipping through.)
 			if ((check > 0 || (check == 0 && bombspot->flags7 & MF7_FORCEZERORADIUSDMG)) && P_CheckSight(thing, bombspot, SF_IGNOREVISIBILITY | SF_IGNOREWATERBOUNDARY))
@@ -6126,6 +6170,7 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bom
 			}
 		}
 	}
+	RadiusTargets.Resize(first);
 	return count;
 }
 
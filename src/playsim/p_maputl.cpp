@@ -79,6 +79,9 @@
 // State.
 #include "po_man.h"
 #include "vm.h"
+#include "c_dispatch.h"
+#include "stats.h"
+#include "d_player.h"
 
 int P_VanillaPointOnDivlineSide(double x, double y, const divline_t* line);
 
@@ -335,11 +338,7 @@ void AActor::UnlinkFromWorld (FLinkContext *ctx)
 
 		while (block != NULL)
 		{
-			if (block->NextActor != NULL)
-			{
-				block->NextActor->PrevActor = block->PrevActor;
-			}
-			*(block->PrevActor) = block->NextActor;
+			Level->blockmap.UnlinkThing(block);
 			FBlockNode *next = block->NextBlock;
 			block->Release ();
 			block = next;
@@ -494,8 +493,8 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 		// When a node is deleted, its sector links (the links starting
 		// at sector_t->touching_thinglist) are broken. When a node is
 		// added, new sector links are created.
-		touching_sectorlist = P_CreateSecNodeList(this, radius, ctx != nullptr? ctx->sector_list : nullptr, &sector_t::touching_thinglist);	// Attach to thing
-		if (renderradius >= 0) touching_rendersectors = P_CreateSecNodeList(this, RenderRadius(), ctx != nullptr ? ctx->render_list : nullptr, &sector_t::touching_renderthings);
+		touching_sectorlist = P_CreateSecNodeList(this, radius, ctx != nullptr? ctx->sector_list : nullptr, &sector_t::touching_thinglist, &SectorListCache);	// Attach to thing
+		if (renderradius >= 0) touching_rendersectors = P_CreateSecNodeList(this, RenderRadius(), ctx != nullptr ? ctx->render_list : nullptr, &sector_t::touching_renderthings, &RenderListCache);
 		else
 		{
 			touching_rendersectors = nullptr;
@@ -535,20 +534,12 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 				{
 					for (int x = x1; x <= x2; ++x)
 					{
-						FBlockNode **link = &Level->blockmap.blocklinks[y*Level->blockmap.bmapwidth + x];
 						FBlockNode *node = FBlockNode::Create(this, x, y, this->Sector->PortalGroup);
 
 						// Link in to block
-						if ((node->NextActor = *link) != NULL)
-						{
-							(*link)->PrevActor = &node->NextActor;
-						}
-						node->PrevActor = link;
-						*link = node;
+						Level->blockmap.LinkThing(node);
 
 						// Link in to actor
-						node->PrevBlock = alink;
-						node->NextBlock = NULL;
 						(*alink) = node;
 						alink = &node->NextBlock;
 					}
@@ -895,7 +886,8 @@ FBlockThingsIterator::FBlockThingsIterator(FLevelLocals *l)
 	minx = maxx = 0;
 	miny = maxy = 0;
 	ClearHash();
-	block = NULL;
+	things = NULL;
+	thingindex = 0;
 }
 
 FBlockThingsIterator::FBlockThingsIterator(FLevelLocals *l, int _minx, int _miny, int _maxx, int _maxy)
@@ -945,12 +937,14 @@ void FBlockThingsIterator::StartBlock(int x, int y)
 	cury = y;
 	if (Level->blockmap.isValidBlock(x, y))
 	{
-		block = Level->blockmap.blocklinks[y*Level->blockmap.bmapwidth + x];
+		things = &Level->blockmap.blockthings[y*Level->blockmap.bmapwidth + x];
+		thingindex = things->Size();
 	}
 	else
 	{
 		// invalid block
-		block = NULL;
+		things = NULL;
+		thingindex = 0;
 	}
 }
 
@@ -977,68 +971,67 @@ AActor *FBlockThingsIterator::Next(bool centeronly)
 {
 	for (;;)
 	{
-		while (block != NULL)
+		while (things != NULL)
 		{
-			AActor *me = block->Me;
-			FBlockNode *mynode = block;
+			// The caller may have unlinked things from this block in the meantime.
+			if (thingindex > (int)things->Size()) thingindex = things->Size();
+			if (thingindex == 0) break;
+
+			// Walk the block backwards so that the most recently linked thing comes first.
+			AActor *me = (*things)[--thingindex].Me;
 			HashEntry *entry;
 			int i;
 
-			block = block->NextActor;
-			// Don't recheck things that were already checked
-			if (mynode->NextBlock == NULL && mynode->PrevBlock == &me->BlockNode)
-			{ // This actor doesn't span blocks, so we know it can only ever be checked once.
-				return me;
-			}
 			if (centeronly)
 			{
 				// Block boundaries for compatibility mode
-				double blockleft = (curx * FBlockmap::MAPBLOCKUNITS) + Level->blockmap.bmaporgx;
-				double blockright = blockleft + FBlockmap::MAPBLOCKUNITS;
-				double blockbottom = (cury * FBlockmap::MAPBLOCKUNITS) + Level->blockmap.bmaporgy;
-				double blocktop = blockbottom + FBlockmap::MAPBLOCKUNITS;
+				double blockleft = (curx * Level->blockmap.blockunits) + Level->blockmap.bmaporgx;
+				double blockright = blockleft + Level->blockmap.blockunits;
+				double blockbottom = (cury * Level->blockmap.blockunits) + Level->blockmap.bmaporgy;
+				double blocktop = blockbottom + Level->blockmap.blockunits;
 
 				// only return actors with the center in this block
-				if (me->X() >= blockleft && me->X() < blockright &&
-					me->Y() >= blockbottom && me->Y() < blocktop)
+				if (me->X() < blockleft || me->X() >= blockright ||
+					me->Y() < blockbottom || me->Y() >= blocktop)
 				{
-					return me;
+					continue;
 				}
 			}
-			else
+
+			// Don't recheck things that were already checked. This is also needed for things
+			// that only occupy one block: unlinking an entry below the cursor shifts the one
+			// that was just returned down into the next slot to be visited.
+			size_t hash = ((size_t)me >> 3) % countof(Buckets);
+			for (i = Buckets[hash]; i >= 0; )
 			{
-				size_t hash = ((size_t)me >> 3) % countof(Buckets);
-				for (i = Buckets[hash]; i >= 0; )
+				entry = GetHashEntry(i);
+				if (entry->Actor == me)
+				{ // I've already been checked. Skip to the next actor.
+					break;
+				}
+				i = entry->Next;
+			}
+			if (i < 0)
+			{ // Add me to the hash table and return me.
+				if (NumFixedHash < (int)countof(FixedHash))
 				{
-					entry = GetHashEntry(i);
-					if (entry->Actor == me)
-					{ // I've already been checked. Skip to the next actor.
-						break;
-					}
-					i = entry->Next;
+					entry = &FixedHash[NumFixedHash];
+					entry->Next = Buckets[hash];
+					Buckets[hash] = NumFixedHash++;
 				}
-				if (i < 0)
-				{ // Add me to the hash table and return me.
-					if (NumFixedHash < (int)countof(FixedHash))
-					{
-						entry = &FixedHash[NumFixedHash];
-						entry->Next = Buckets[hash];
-						Buckets[hash] = NumFixedHash++;
-					}
-					else
+				else
+				{
+					if (DynHash.Size() == 0)
 					{
-						if (DynHash.Size() == 0)
-						{
-							DynHash.Grow(50);
-						}
-						i = DynHash.Reserve(1);
-						entry = &DynHash[i];
-						entry->Next = Buckets[hash];
-						Buckets[hash] = i + countof(FixedHash);
+						DynHash.Grow(50);
 					}
-					entry->Actor = me;
-					return me;
+					i = DynHash.Reserve(1);
+					entry = &DynHash[i];
+					entry->Next = Buckets[hash];
+					Buckets[hash] = i + countof(FixedHash);
 				}
+				entry->Actor = me;
+				return me;
 			}
 		}
 
@@ -1162,7 +1155,7 @@ void FMultiBlockThingsIterator::Reset()
 //
 //===========================================================================
 
-TArray<intercept_t> FPathTraverse::intercepts(128);
+thread_local TArray<intercept_t> FPathTraverse::DefaultIntercepts(128);
 
 
 //===========================================================================
@@ -1395,22 +1388,46 @@ void FPathTraverse::AddThingIntercepts (int bx, int by, FBlockThingsIterator &it
 
 intercept_t *FPathTraverse::Next()
 {
-	intercept_t *in = NULL;
+	if (intercept_pos >= intercept_end) return NULL;
 
-	double dist = FLT_MAX;
-	for (unsigned scanpos = intercept_index; scanpos < intercepts.Size (); scanpos++)
+	intercept_t *in = &intercepts[intercept_pos];
+	if (in->frac > 1.) return NULL;	// checked everything in range
+	intercept_pos++;
+	in->done = true;
+	return in;
+}
+
+//===========================================================================
+//
+// FPathTraverse :: SortIntercepts
+//
+// Sorts the intercepts added since 'start' into the already sorted
+// ones in front of them. Since the blocks are visited in order along
+// the trace, new intercepts rarely need to move far, so this is done
+// with an insertion sort. It's stable, so intercepts at the same
+// distance keep the order in which they were found.
+//
+//===========================================================================
+
+void FPathTraverse::SortIntercepts(unsigned start)
+{
+	for (unsigned i = start; i < intercepts.Size(); i++)
 	{
-		intercept_t *scan = &intercepts[scanpos];
-		if (scan->frac < dist && !scan->done)
+		intercept_t in = intercepts[i];
+		if (in.frac != in.frac)
+		{
+			// NaNs never get returned.
+			intercepts.Delete(i--);
+			continue;
+		}
+		unsigned j = i;
+		while (j > intercept_index && intercepts[j - 1].frac > in.frac)
 		{
-			dist = scan->frac;
-			in = scan;
+			intercepts[j] = intercepts[j - 1];
+			j--;
 		}
+		intercepts[j] = in;
 	}
-	
-	if (dist > 1. || in == NULL) return NULL;	// checked everything in range			
-	in->done = true;
-	return in;
 }
 
 //===========================================================================
@@ -1460,7 +1477,7 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 	}
 
 	validcount++;
-	intercept_index = intercepts.Size();
+	intercept_index = intercept_pos = intercepts.Size();
 	Startfrac = startfrac;
 
 	if (flags & PT_DELTA)
@@ -1471,13 +1488,13 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 
 	x1 -= Level->blockmap.bmaporgx;
 	y1 -= Level->blockmap.bmaporgy;
-	xt1 = x1 / FBlockmap::MAPBLOCKUNITS;
-	yt1 = y1 / FBlockmap::MAPBLOCKUNITS;
+	xt1 = x1 / Level->blockmap.blockunits;
+	yt1 = y1 / Level->blockmap.blockunits;
 
 	x2 -= Level->blockmap.bmaporgx;
 	y2 -= Level->blockmap.bmaporgy;
-	xt2 = x2 / FBlockmap::MAPBLOCKUNITS;
-	yt2 = y2 / FBlockmap::MAPBLOCKUNITS;
+	xt2 = x2 / Level->blockmap.blockunits;
+	yt2 = y2 / Level->blockmap.blockunits;
 
 	mapx = xs_FloorToInt(xt1);
 	mapy = xs_FloorToInt(yt1);
@@ -1556,6 +1573,7 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 	FBlockThingsIterator btit(Level);
 	for (count = 0 ; count < 1000 ; count++)
 	{
+		unsigned blockstart = intercepts.Size();
 		if (flags & PT_ADDLINES)
 		{
 			AddLineIntercepts(mapx, mapy);
@@ -1565,6 +1583,7 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 		{
 			AddThingIntercepts(mapx, mapy, btit, compatible);
 		}
+		SortIntercepts(blockstart);
 				
 		// both coordinates reached the end, so end the traversing.
 		if ((mapxstep | mapystep) == 0)
@@ -1611,6 +1630,7 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 					AddThingIntercepts(mapx + mapxstep, mapy, btit, false);
 					AddThingIntercepts(mapx, mapy + mapystep, btit, false);
 				}
+				SortIntercepts(blockstart);
 				xintercept += xstep;
 				yintercept += ystep;
 				mapx += mapxstep;
@@ -1627,6 +1647,7 @@ void FPathTraverse::init(double x1, double y1, double x2, double y2, int flags,
 			break;
 		}
 	}
+	intercept_end = intercepts.Size();
 }
 
 //===========================================================================
@@ -1702,7 +1723,8 @@ DEFINE_ACTION_FUNCTION_NATIVE(AActor, CheckFov, P_CheckFov)
 // P_RoughMonsterSearch
 //
 // Searches though the surrounding mapblocks for monsters/players
-//		distance is in FBlockmap::MAPBLOCKUNITS
+//		distance is in blocks of FBlockmap::MAPBLOCKUNITS, regardless of
+//		the block size the map actually uses.
 //===========================================================================
 
 AActor *P_BlockmapSearch (AActor *mo, int distance, AActor *(*check)(AActor*, int, void *), void *params)
@@ -1723,6 +1745,10 @@ AActor *P_BlockmapSearch (AActor *mo, int distance, AActor *(*check)(AActor*, in
 
 	startX = Level->blockmap.GetBlockX(mo->X());
 	startY = Level->blockmap.GetBlockY(mo->Y());
+	if (Level->blockmap.blockunits != FBlockmap::MAPBLOCKUNITS)
+	{
+		distance = (distance * FBlockmap::MAPBLOCKUNITS + Level->blockmap.blockunits - 1) / Level->blockmap.blockunits;
+	}
 	validcount++;
 	
 	if (Level->blockmap.isValidBlock(startX, startY))
@@ -1815,10 +1841,11 @@ static AActor *RoughBlockCheck (AActor *mo, int index, void *param)
 {
 	BlockCheckInfo *info = (BlockCheckInfo *)param;
 
-	FBlockNode *link;
+	auto &things = mo->Level->blockmap.blockthings[index];
 
-	for (link = mo->Level->blockmap.blocklinks[index]; link != NULL; link = link->NextActor)
+	for (unsigned i = things.Size(); i-- > 0; )
 	{
+		auto link = &things[i];
 		if (link->Me != mo)
 		{
 			if (info->onlyseekable && !mo->CanSeek(link->Me))
@@ -1978,11 +2005,13 @@ subsector_t *FLevelLocals::PointInSubsector(double x, double y)
 
 	fixed_t xx = FloatToFixed(x);
 	fixed_t yy = FloatToFixed(y);
-	do
+	auto start = gamesubsectorgrid.GetStart(xx, yy);
+	if (start != nullptr) node = (node_t *)start;
+	while (!((size_t)node & 1))
 	{
 		side = R_PointOnSide(xx, yy, node);
 		node = (node_t *)node->children[side];
-	} while (!((size_t)node & 1));
+	}
 
 	return (subsector_t *)((uint8_t *)node - 1);
 }
@@ -2032,17 +2061,95 @@ subsector_t *FLevelLocals::PointInRenderSubsector (fixed_t x, fixed_t y)
 		return &subsectors[0];
 	
 	node = HeadNode();
+	auto start = rendersubsectorgrid.GetStart(x, y);
+	if (start != nullptr) node = (node_t *)start;
 	
-	do
+	while (!((size_t)node & 1))
 	{
 		side = R_PointOnSide (x, y, node);
 		node = (node_t *)node->children[side];
 	}
-	while (!((size_t)node & 1));
 	
 	return (subsector_t *)((uint8_t *)node - 1);
 }
 
+//==========================================================================
+//
+// Checks if an entire grid cell lies on one side of a node's partition
+// line. R_PointOnSide is linear as long as its coordinate differences
+// don't overflow, so checking the corners is enough then.
+//
+//==========================================================================
+
+static bool CellOnNodeSide(int64_t x1, int64_t y1, int64_t x2, int64_t y2, const node_t *node, int &side)
+{
+	if (x1 - node->x < INT32_MIN || x2 - node->x > INT32_MAX || y1 - node->y < INT32_MIN || y2 - node->y > INT32_MAX)
+	{
+		return false;
+	}
+	side = R_PointOnSide(fixed_t(x1), fixed_t(y1), node);
+	return R_PointOnSide(fixed_t(x2), fixed_t(y1), node) == side &&
+		R_PointOnSide(fixed_t(x1), fixed_t(y2), node) == side &&
+		R_PointOnSide(fixed_t(x2), fixed_t(y2), node) == side;
+}
+
+//==========================================================================
+//
+// FSubsectorGrid :: Build
+//
+//==========================================================================
+
+void FSubsectorGrid::Build(const FLevelLocals *Level, node_t *head)
+{
+	enum
+	{
+		MAXCELLS = 65536,
+		MINSHIFT = FRACBITS + 7,	// 128 map units
+	};
+
+	Clear();
+	if (head == nullptr || Level->vertexes.Size() == 0) return;
+
+	double minx = FLT_MAX, miny = FLT_MAX, maxx = -FLT_MAX, maxy = -FLT_MAX;
+	for (auto &v : Level->vertexes)
+	{
+		minx = min(minx, v.fX());
+		miny = min(miny, v.fY());
+		maxx = max(maxx, v.fX());
+		maxy = max(maxy, v.fY());
+	}
+	orgx = clamp<int64_t>(FloatToFixed(minx), INT32_MIN, INT32_MAX);
+	orgy = clamp<int64_t>(FloatToFixed(miny), INT32_MIN, INT32_MAX);
+	int64_t spanx = clamp<int64_t>(FloatToFixed(maxx), INT32_MIN, INT32_MAX) - orgx + 1;
+	int64_t spany = clamp<int64_t>(FloatToFixed(maxy), INT32_MIN, INT32_MAX) - orgy + 1;
+
+	for (shift = MINSHIFT; (((spanx - 1) >> shift) + 1) * (((spany - 1) >> shift) + 1) > MAXCELLS; shift++)
+	{
+	}
+	width = int(((spanx - 1) >> shift) + 1);
+	height = int(((spany - 1) >> shift) + 1);
+	cells.Resize(width * height);
+
+	for (int y = 0; y < height; y++)
+	{
+		int64_t y1 = orgy + (int64_t(y) << shift);
+		int64_t y2 = min<int64_t>(y1 + (int64_t(1) << shift) - 1, INT32_MAX);
+		for (int x = 0; x < width; x++)
+		{
+			int64_t x1 = orgx + (int64_t(x) << shift);
+			int64_t x2 = min<int64_t>(x1 + (int64_t(1) << shift) - 1, INT32_MAX);
+			void *node = head;
+			int side;
+
+			while (!((size_t)node & 1) && CellOnNodeSide(x1, y1, x2, y2, (node_t *)node, side))
+			{
+				node = ((node_t *)node)->children[side];
+			}
+			cells[y * width + x] = node;
+		}
+	}
+}
+
 
 //==========================================================================
 //
@@ -2092,3 +2199,48 @@ int BoxOnLineSide(const FBoundingBox &box, const line_t* ld)
 	return (p1 == p2) ? p1 : -1;
 }
 
+
+//===========================================================================
+//
+// CCMD tracebench
+//
+// Runs a number of hitscan-like traversals from the player's position in
+// random directions and reports the time spent. The directions come from
+// a private generator so that the game's RNG is left alone.
+//
+//===========================================================================
+
+CCMD(tracebench)
+{
+	auto Level = primaryLevel;
+	if (Level == nullptr || players[consoleplayer].mo == nullptr)
+	{
+		return;
+	}
+	int count = argv.argc() > 1 ? (int)strtol(argv[1], nullptr, 0) : 10000;
+	double range = argv.argc() > 2 ? strtod(argv[2], nullptr) : 8192.;
+	if (count <= 0 || range <= 0)
+	{
+		Printf("Usage: tracebench [count] [range]\n");
+		return;
+	}
+
+	DVector2 start = players[consoleplayer].mo->Pos().XY();
+	uint32_t seed = 0x9e3779b9;
+	unsigned total = 0;
+	cycle_t timer;
+	timer.Reset();
+	timer.Clock();
+	for (int i = 0; i < count; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		DAngle an = DAngle::fromDeg((seed >> 8) * (360. / (1 << 24)));
+		FPathTraverse it(Level, start.X, start.Y, an.Cos() * range, an.Sin() * range, PT_ADDLINES | PT_ADDTHINGS | PT_DELTA);
+		while (it.Next() != nullptr)
+		{
+			total++;
+		}
+	}
+	timer.Unclock();
+	Printf("%d traces, %u intercepts, %.3f ms (%.3f us per trace)\n", count, total, timer.TimeMS(), timer.TimeMS() * 1000. / count);
+}
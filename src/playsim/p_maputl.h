@@ -10,6 +10,7 @@
 
 extern int validcount;
 struct FBlockNode;
+struct FBlockThing;
 
 struct divline_t
 {
@@ -286,7 +287,8 @@ class FBlockThingsIterator
 
 	int curx, cury;
 
-	FBlockNode *block;
+	TArray<FBlockThing> *things;
+	int thingindex;
 
 	int Buckets[32];
 
@@ -322,6 +324,9 @@ public:
 	void init(const FBoundingBox &box, bool clearhash = true);
 	AActor *Next(bool centeronly = false);
 	void Reset() { StartBlock(minx, miny); }
+
+	// Skips things whose bounds at link time do not touch the box passed to init.
+	// Only for callers that would reject those things anyway.
 };
 
 class FMultiBlockThingsIterator
@@ -362,18 +367,22 @@ public:
 class FPathTraverse
 {
 protected:
-	static TArray<intercept_t> intercepts;
+	// Scratch space used when the caller doesn't provide its own. Nested traversals append behind the current one's intercepts.
+	static thread_local TArray<intercept_t> DefaultIntercepts;
 
+	TArray<intercept_t> &intercepts;
 	FLevelLocals *Level;
 	divline_t trace;
 	double Startfrac;
-	unsigned int intercept_index;
-	unsigned int intercept_count;
+	unsigned int intercept_index;	// first intercept belonging to this traversal
+	unsigned int intercept_end;		// one past the last one
+	unsigned int intercept_pos;		// next one to be returned by Next()
 	unsigned int count;
 
 	virtual void AddLineIntercepts(int bx, int by);
 	virtual void AddThingIntercepts(int bx, int by, FBlockThingsIterator &it, bool compatible);
-	FPathTraverse(FLevelLocals *l) 
+	void SortIntercepts(unsigned start);
+	FPathTraverse(FLevelLocals *l) : intercepts(DefaultIntercepts)
 	{
 		Level = l;
 	}
@@ -382,6 +391,13 @@ public:
 	intercept_t *Next();
 
 	FPathTraverse(FLevelLocals *l, double x1, double y1, double x2, double y2, int flags, double startfrac = 0)
+		: intercepts(DefaultIntercepts)
+	{
+		Level = l;
+		init(x1, y1, x2, y2, flags, startfrac);
+	}
+	FPathTraverse(TArray<intercept_t> &buffer, FLevelLocals *l, double x1, double y1, double x2, double y2, int flags, double startfrac = 0)
+		: intercepts(buffer)
 	{
 		Level = l;
 		init(x1, y1, x2, y2, flags, startfrac);
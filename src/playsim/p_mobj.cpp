@@ -3573,6 +3573,75 @@ DEFINE_ACTION_FUNCTION(AActor, CheckPortalTransition)
 	return 0;
 }
 
+//==========================================================================
+//
+// AActor :: IsAsleep
+//
+// An actor sleeps while it sits in a frozen state with nothing moving it,
+// i.e. while a call to Tick could not change anything. The test is redone
+// every tic, so whatever disturbs the actor (a state change from damage or
+// a script, a push, a moving floor, a sound waking up a monster) wakes it
+// right away without needing to be hooked explicitly. Anything the test
+// cannot vouch for, like scripted Tick overrides, keeps the actor awake.
+//
+//==========================================================================
+
+bool AActor::IsAsleep()
+{
+	if ((ObjectFlags & OF_JustSpawned) || tics != -1 || freezetics > 0 || state == nullptr ||
+		player != nullptr || Inventory != nullptr || effects || PoisonDurationReceived)
+	{
+		return false;
+	}
+	if (!Vel.isZero() || Z() != floorz || BlockingMobj || BlockingFloor || BlockingCeiling || Blocking3DFloor)
+	{
+		return false;
+	}
+	if ((flags & (MF_MISSILE | MF_SKULLFLY | MF_STEALTH)) || (flags2 & (MF2_BLASTED | MF2_WINDTHRUST)) ||
+		(flags4 & (MF4_VFRICTION | MF4_SCROLLMOVE)) || (flags6 & (MF6_TOUCHY | MF6_BOSSCUBE)) ||
+		(flags7 & MF7_HANDLENODELAY) || (flags8 & MF8_INSCROLLSEC))
+	{
+		return false;
+	}
+	if ((flags5 & MF5_NOINTERACTION) && !(flags & MF_NOBLOCKMAP))
+	{
+		return false;
+	}
+	// Resting on the floor calls Crash, which only does something the first time.
+	if (((flags & MF_CORPSE) || (flags6 & MF6_KILLED)) && !(flags3 & MF3_CRASHED) &&
+		!(flags & MF_ICECORPSE) && !(flags6 & MF6_DONTCORPSE))
+	{
+		return false;
+	}
+	if (state->GetCanRaise() || (flags5 & MF5_ALWAYSRESPAWN) ||
+		((flags3 & MF3_ISMONSTER) && !(flags2 & MF2_DORMANT) && !(flags5 & MF5_NEVERRESPAWN) && G_SkillProperty(SKILLP_Respawn)))
+	{
+		return false;
+	}
+	if (Level->BotInfo.botnum && !demoplayback)
+	{
+		return false;
+	}
+
+	// Sectors that can change the actor's surroundings without moving it.
+	if ((Sector->Flags & SECF_KILLMONSTERS) || Sector->heightsec != nullptr || Sector->e->XFloor.ffloors.Size() > 0 ||
+		!Sector->PortalBlocksMovement(sector_t::ceiling) || !Sector->PortalBlocksMovement(sector_t::floor) ||
+		((flags & MF_SOLID) && floorsector->floorplane.isSlope()))
+	{
+		return false;
+	}
+
+	// Last, make sure no script replaced Tick with something else.
+	static unsigned VIndex = ~0u;
+	if (VIndex == ~0u)
+	{
+		VIndex = GetVirtualIndex(RUNTIME_CLASS(AActor), "Tick");
+		assert(VIndex != ~0u);
+	}
+	auto &virtuals = GetClass()->Virtuals;
+	return virtuals.Size() > VIndex && virtuals[VIndex] == RUNTIME_CLASS(AActor)->Virtuals[VIndex];
+}
+
 //
 // P_MobjThinker
 //
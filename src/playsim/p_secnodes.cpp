@@ -26,7 +26,9 @@
 
 #include "g_levellocals.h"
 #include "p_maputl.h"
+#include "p_local.h"
 #include "actor.h"
+#include "stats.h"
 
 //=============================================================================
 // phares 3/21/98
@@ -37,6 +39,13 @@
 msecnode_t *headsecnode = nullptr;
 FMemArena secnodearena;
 
+// How far beyond its radius an actor that touches no lines gets checked
+// for lines, so that small moves don't need to rebuild its sector list.
+static const double SECNODE_SAFEMARGIN = 32.;
+
+static int SecNodeGeneration = 1;
+static unsigned SecNodeCacheHits, SecNodeRebuilds;
+
 //=============================================================================
 //
 // P_GetSecnode
@@ -220,9 +229,56 @@ void P_DelSeclist(portnode_t *node, portnode_t *FLinePortal::*sechead)
 //
 //=============================================================================
 
-msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector_list, msecnode_t *sector_t::*seclisthead)
+//=============================================================================
+//
+// P_InvalidateSecNodeCaches
+//
+// Called when lines move, so that no actor relies on its cached empty area.
+//
+//=============================================================================
+
+void P_InvalidateSecNodeCaches()
+{
+	if (++SecNodeGeneration == 0) SecNodeGeneration = 1;
+}
+
+//=============================================================================
+//
+// BoxTouchesLines
+//
+// Checks if any line in the box would be added by P_CreateSecNodeList.
+//
+//=============================================================================
+
+static bool BoxTouchesLines(FLevelLocals *Level, const FBoundingBox &box)
+{
+	FBlockLinesIterator it(Level, box);
+	line_t *ld;
+
+	while ((ld = it.Next()))
+	{
+		if (inRange(box, ld) && BoxOnLineSide(box, ld) == -1)
+			return true;
+	}
+	return false;
+}
+
+msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector_list, msecnode_t *sector_t::*seclisthead, FSecNodeCache *cache)
 {
 	msecnode_t *node;
+	int linecount = 0;
+
+	// If the actor only touched its own sector and is still inside the area
+	// that is known to be free of lines the list stays the same. 
+	if (cache != nullptr && cache->Generation == SecNodeGeneration && sector_list != nullptr &&
+		sector_list->m_tnext == nullptr && sector_list->m_sector == thing->Sector &&
+		fabs(thing->X() - cache->Center.X) <= cache->HalfSize - radius &&
+		fabs(thing->Y() - cache->Center.Y) <= cache->HalfSize - radius)
+	{
+		SecNodeCacheHits++;
+		return sector_list;
+	}
+	SecNodeRebuilds++;
 
 	// First, clear out the existing m_thing fields. As each node is
 	// added or verified as needed, m_thing will be set properly. When
@@ -246,6 +302,7 @@ msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector
 			continue;
 
 		// This line crosses through the object.
+		linecount++;
 
 		// Collect the sector(s) from the line and add to the
 		// sector_list you're examining. If the Thing ends up being
@@ -286,9 +343,36 @@ msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector
 			node = node->m_tnext;
 		}
 	}
+
+	if (cache != nullptr)
+	{
+		// Remember how much room the actor has before it reaches the next line.
+		// The check is only made with the margin added, anything smaller isn't
+		// worth the extra search.
+		cache->Generation = 0;
+		if (linecount == 0)
+		{
+			double halfsize = radius + SECNODE_SAFEMARGIN;
+			if (!BoxTouchesLines(thing->Level, FBoundingBox(thing->X(), thing->Y(), halfsize)))
+			{
+				cache->Center = thing->Pos().XY();
+				cache->HalfSize = halfsize;
+				cache->Generation = SecNodeGeneration;
+			}
+		}
+	}
 	return sector_list;
 }
 
+ADD_STAT(secnodes)
+{
+	FString out;
+	unsigned total = SecNodeCacheHits + SecNodeRebuilds;
+	out.Format("Sector list updates: %u skipped, %u rebuilt (%.1f%% skipped)", SecNodeCacheHits, SecNodeRebuilds,
+		total > 0 ? SecNodeCacheHits * 100. / total : 0.);
+	return out;
+}
+
 //=============================================================================
 //
 // P_DelPortalnode
@@ -468,9 +552,7 @@ FBlockNode *FBlockNode::Create(AActor *who, int x, int y, int group)
 	}
 	block->BlockIndex = x + y * who->Level->blockmap.bmapwidth;
 	block->Me = who;
-	block->NextActor = nullptr;
-	block->PrevActor = nullptr;
-	block->PrevBlock = nullptr;
+	block->Group = group;
 	block->NextBlock = nullptr;
 	return block;
 }
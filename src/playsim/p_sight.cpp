@@ -87,8 +87,8 @@ struct SightTask
 };
 
 
-static TArray<intercept_t> intercepts (128);
-static TArray<SightTask> portals(32);
+static thread_local TArray<intercept_t> intercepts (128);
+static thread_local TArray<SightTask> portals(32);
 
 class SightCheck
 {
@@ -669,13 +669,13 @@ bool SightCheck::P_SightPathTraverse ()
 
 	x1 -= Level->blockmap.bmaporgx;
 	y1 -= Level->blockmap.bmaporgy;
-	xt1 = x1 / FBlockmap::MAPBLOCKUNITS;
-	yt1 = y1 / FBlockmap::MAPBLOCKUNITS;
+	xt1 = x1 / Level->blockmap.blockunits;
+	yt1 = y1 / Level->blockmap.blockunits;
 
 	x2 -= Level->blockmap.bmaporgx;
 	y2 -= Level->blockmap.bmaporgy;
-	xt2 = x2 / FBlockmap::MAPBLOCKUNITS;
-	yt2 = y2 / FBlockmap::MAPBLOCKUNITS;
+	xt2 = x2 / Level->blockmap.blockunits;
+	yt2 = y2 / Level->blockmap.blockunits;
 
 	mapx = xs_FloorToInt(xt1);
 	mapy = xs_FloorToInt(yt1);
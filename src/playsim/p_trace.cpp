@@ -41,6 +41,9 @@
 #include "g_levellocals.h"
 #include "p_terrain.h"
 #include "vm.h"
+#include "c_dispatch.h"
+#include "stats.h"
+#include "d_player.h"
 
 //==========================================================================
 //
@@ -67,6 +70,7 @@ struct FTraceInfo
 	double startfrac;
 	double limitz;
 	int ptflags;
+	struct FTraceLineCache *LineCache;
 
 	// These are required for 3D-floor checking
 	// to create a fake sector with a floor 
@@ -105,6 +109,149 @@ struct FTraceInfo
 
 static bool EditTraceResult (uint32_t flags, FTraceResults &res);
 
+//==========================================================================
+//
+// Line data shared by a batch of traces starting at the same point.
+//
+// Everything in the line crossing test that does not depend on the
+// trace's direction is calculated once per line and block, in exactly
+// the form FPathTraverse::AddLineIntercepts uses it, so the batched
+// traces produce the same intercepts as separate ones.
+// The map geometry may not change while a batch is being traced.
+//
+//==========================================================================
+
+struct FTraceLineCache
+{
+	struct FLineData
+	{
+		line_t *line;
+		double dy1, dx1;	// first vertex relative to the origin, as P_PointOnDivlineSide uses it
+		double dy2, dx2;	// second vertex
+		double num;			// numerator of P_InterceptVector
+		double ldx, ldy;
+	};
+
+	struct FBlockRange
+	{
+		unsigned start, count;
+	};
+
+	FLevelLocals *Level = nullptr;
+	DVector2 Origin;
+	TArray<FLineData> Lines;
+	TMap<int, FBlockRange> Blocks;
+
+	void AddLine(line_t *ld);
+	FBlockRange GetBlock(int bx, int by);
+};
+
+void FTraceLineCache::AddLine(line_t *ld)
+{
+	FLineData &data = Lines[Lines.Reserve(1)];
+	data.line = ld;
+	data.dy1 = ld->v1->fY() - Origin.Y;
+	data.dx1 = Origin.X - ld->v1->fX();
+	data.dy2 = ld->v2->fY() - Origin.Y;
+	data.dx2 = Origin.X - ld->v2->fX();
+	data.ldx = ld->Delta().X;
+	data.ldy = ld->Delta().Y;
+	data.num = (ld->v1->fX() - Origin.X) * data.ldy + (Origin.Y - ld->v1->fY()) * data.ldx;
+}
+
+//==========================================================================
+//
+// Collects the lines of a block in the same order FBlockLinesIterator
+// returns them: polyobject lines first, then the block's own lines.
+//
+//==========================================================================
+
+FTraceLineCache::FBlockRange FTraceLineCache::GetBlock(int bx, int by)
+{
+	auto &blockmap = Level->blockmap;
+	int key = by * blockmap.bmapwidth + bx;
+	auto check = Blocks.CheckKey(key);
+	if (check != nullptr) return *check;
+
+	FBlockRange range = { Lines.Size(), 0 };
+	if (blockmap.isValidBlock(bx, by))
+	{
+		unsigned offset = unsigned(key);
+		for (auto link = Level->PolyBlockMap.Size() > offset ? Level->PolyBlockMap[offset] : nullptr; link != nullptr; link = link->next)
+		{
+			if (link->polyobj)
+			{
+				for (auto ld : link->polyobj->Linedefs) AddLine(ld);
+			}
+		}
+		for (int *list = blockmap.GetLines(bx, by); list != nullptr && *list != -1; list++)
+		{
+			AddLine(&Level->lines[*list]);
+		}
+	}
+	range.count = Lines.Size() - range.start;
+	Blocks[key] = range;
+	return range;
+}
+
+//==========================================================================
+//
+// Path traverser that takes its line intercepts from a line cache
+// while the trace still starts at the cache's origin.
+//
+//==========================================================================
+
+class FTracePathTraverse : public FPathTraverse
+{
+	FTraceLineCache *Cache;
+
+	void AddLineIntercepts(int bx, int by) override;
+
+public:
+	FTracePathTraverse(FLevelLocals *l, FTraceLineCache *cache, double x1, double y1, double x2, double y2, int flags, double startfrac)
+		: FPathTraverse(l), Cache(cache)
+	{
+		init(x1, y1, x2, y2, flags, startfrac);
+	}
+};
+
+void FTracePathTraverse::AddLineIntercepts(int bx, int by)
+{
+	if (Cache == nullptr || trace.x != Cache->Origin.X || trace.y != Cache->Origin.Y)
+	{
+		// moved through a portal.
+		FPathTraverse::AddLineIntercepts(bx, by);
+		return;
+	}
+
+	auto range = Cache->GetBlock(bx, by);
+	const double tdx = trace.dx, tdy = trace.dy;
+	for (unsigned i = range.start; i < range.start + range.count; i++)
+	{
+		const auto &data = Cache->Lines[i];
+		line_t *ld = data.line;
+
+		if (ld->validcount == validcount) continue;
+		ld->validcount = validcount;
+
+		int s1 = data.dy1 * tdx + data.dx1 * tdy > EQUAL_EPSILON;
+		int s2 = data.dy2 * tdx + data.dx2 * tdy > EQUAL_EPSILON;
+		if (s1 == s2) continue;	// line isn't crossed
+
+		double den = data.ldy * tdx - data.ldx * tdy;
+		double frac = den == 0 ? 0 : data.num / den;
+		if (frac < Startfrac || frac > 1.) continue;	// behind source or beyond end point
+
+		intercept_t newintercept;
+
+		newintercept.frac = frac;
+		newintercept.isaline = true;
+		newintercept.done = false;
+		newintercept.d.line = ld;
+		intercepts.Push(newintercept);
+	}
+}
+
 
 
 static void GetPortalTransition(DVector3 &pos, sector_t *&sec)
@@ -149,9 +296,9 @@ static bool isLiquid(F3DFloor *ff)
 //
 //==========================================================================
 
-bool Trace(const DVector3 &start, sector_t *sector, const DVector3 &direction, double maxDist,
+static bool TraceRay(const DVector3 &start, sector_t *sector, const DVector3 &direction, double maxDist,
 	ActorFlags actorMask, uint32_t wallMask, AActor *ignore, FTraceResults &res, uint32_t flags,
-	ETraceStatus(*callback)(FTraceResults &res, void *), void *callbackdata)
+	ETraceStatus(*callback)(FTraceResults &res, void *), void *callbackdata, FTraceLineCache *cache)
 {
 	FTraceInfo inf;
 	FTraceResults tempResult;
@@ -178,8 +325,15 @@ bool Trace(const DVector3 &start, sector_t *sector, const DVector3 &direction, d
 	inf.sectorsel=0;
 	inf.startfrac = 0;
 	inf.limitz = inf.Start.Z;
+	inf.LineCache = cache;
 	memset(&res, 0, sizeof(res));
 
+	if (cache != nullptr && cache->Level == nullptr)
+	{
+		cache->Level = inf.Level;
+		cache->Origin = inf.Start.XY();
+	}
+
 	if ((flags & TRACE_ReportPortals) && callback != NULL)
 	{
 		tempResult.HitType = TRACE_CrossingPortal;
@@ -207,6 +361,39 @@ bool Trace(const DVector3 &start, sector_t *sector, const DVector3 &direction, d
 	}
 }
 
+bool Trace(const DVector3 &start, sector_t *sector, const DVector3 &direction, double maxDist,
+	ActorFlags actorMask, uint32_t wallMask, AActor *ignore, FTraceResults &res, uint32_t flags,
+	ETraceStatus(*callback)(FTraceResults &res, void *), void *callbackdata)
+{
+	return TraceRay(start, sector, direction, maxDist, actorMask, wallMask, ignore, res, flags, callback, callbackdata, nullptr);
+}
+
+//==========================================================================
+//
+// Traces several rays from the same starting point, e.g. the pellets
+// of a shotgun blast. The results are the same as calling Trace for
+// each direction in turn, but the work on the map lines the rays have
+// in common is only done once. Returns the number of rays that hit
+// something.
+//
+//==========================================================================
+
+int TraceBatch(const DVector3 &start, sector_t *sector, const DVector3 *directions, int count, double maxDist,
+	ActorFlags actorMask, uint32_t wallMask, AActor *ignore, FTraceResults *res, bool *hits, uint32_t flags,
+	ETraceStatus(*callback)(FTraceResults &res, void *), void *callbackdata)
+{
+	FTraceLineCache cache;
+	int numhits = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		bool hit = TraceRay(start, sector, directions[i], maxDist, actorMask, wallMask, ignore, res[i], flags, callback, callbackdata, &cache);
+		if (hits != nullptr) hits[i] = hit;
+		if (hit) numhits++;
+	}
+	return numhits;
+}
+
 
 //============================================================================
 //
@@ -779,7 +966,7 @@ bool FTraceInfo::TraceTraverse (int ptflags)
 	// Do a 3D floor check in the starting sector
 	Setup3DFloors();
 
-	FPathTraverse it(Level, Start.X, Start.Y, Vec.X * MaxDist, Vec.Y * MaxDist, ptflags | PT_DELTA, startfrac);
+	FTracePathTraverse it(Level, LineCache, Start.X, Start.Y, Vec.X * MaxDist, Vec.Y * MaxDist, ptflags | PT_DELTA, startfrac);
 	intercept_t *in;
 	int lastsplashsector = -1;
 
@@ -1127,3 +1314,70 @@ ETraceStatus DLineTracer::CallZScriptCallback()
 
 	return TRACE_Stop;
 }
+
+//==========================================================================
+//
+// CCMD tracebatchtest
+//
+// Fires a spread of hitscan traces from the player's view, once one by
+// one and once as a batch, checks that both give the same results and
+// prints the time taken by each.
+//
+//==========================================================================
+
+CCMD(tracebatchtest)
+{
+	auto mo = players[consoleplayer].mo;
+	if (mo == nullptr)
+	{
+		return;
+	}
+	int count = argv.argc() > 1 ? (int)strtol(argv[1], nullptr, 0) : 20;
+	int repeat = argv.argc() > 2 ? (int)strtol(argv[2], nullptr, 0) : 1000;
+	if (count <= 0 || repeat <= 0)
+	{
+		Printf("Usage: tracebatchtest [rays] [repeat]\n");
+		return;
+	}
+
+	DVector3 start = mo->PosPlusZ(mo->Height / 2);
+	TArray<DVector3> dirs(count, true);
+	TArray<FTraceResults> serial(count, true), batch(count, true);
+	TArray<bool> serialhit(count, true), batchhit(count, true);
+	uint32_t seed = 0x9e3779b9;
+	for (auto &dir : dirs)
+	{
+		seed = seed * 1664525 + 1013904223;
+		DAngle an = mo->Angles.Yaw + DAngle::fromDeg(((seed >> 8) & 0xffff) * (11.2 / 0x10000) - 5.6);
+		DAngle pitch = mo->Angles.Pitch + DAngle::fromDeg((seed >> 24) * (7.1 / 0x100) - 3.55);
+		double pc = pitch.Cos();
+		dir = { pc * an.Cos(), pc * an.Sin(), -pitch.Sin() };
+	}
+
+	cycle_t serialtime, batchtime;
+	serialtime.Reset();
+	batchtime.Reset();
+	for (int r = 0; r < repeat; r++)
+	{
+		serialtime.Clock();
+		for (int i = 0; i < count; i++)
+		{
+			serialhit[i] = Trace(start, mo->Sector, dirs[i], 8192., MF_SHOOTABLE, ML_BLOCKEVERYTHING | ML_BLOCKHITSCAN, mo, serial[i], TRACE_NoSky);
+		}
+		serialtime.Unclock();
+		batchtime.Clock();
+		TraceBatch(start, mo->Sector, dirs.Data(), count, 8192., MF_SHOOTABLE, ML_BLOCKEVERYTHING | ML_BLOCKHITSCAN, mo, batch.Data(), batchhit.Data(), TRACE_NoSky);
+		batchtime.Unclock();
+	}
+
+	int mismatches = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (serialhit[i] != batchhit[i] || serial[i].HitType != batch[i].HitType || serial[i].Distance != batch[i].Distance ||
+			serial[i].Actor != batch[i].Actor || serial[i].Line != batch[i].Line || serial[i].HitPos != batch[i].HitPos)
+		{
+			mismatches++;
+		}
+	}
+	Printf("%d rays: serial %.3f ms, batched %.3f ms, %d mismatches\n", count, serialtime.TimeMS() / repeat, batchtime.TimeMS() / repeat, mismatches);
+}
@@ -115,6 +115,10 @@ bool Trace(const DVector3 &start, sector_t *sector, const DVector3 &direction, d
 	ActorFlags ActorMask, uint32_t WallMask, AActor *ignore, FTraceResults &res, uint32_t traceFlags = 0,
 	ETraceStatus(*callback)(FTraceResults &res, void *) = NULL, void *callbackdata = NULL);
 
+int TraceBatch(const DVector3 &start, sector_t *sector, const DVector3 *directions, int count, double maxDist,
+	ActorFlags ActorMask, uint32_t WallMask, AActor *ignore, FTraceResults *res, bool *hits = NULL, uint32_t traceFlags = 0,
+	ETraceStatus(*callback)(FTraceResults &res, void *) = NULL, void *callbackdata = NULL);
+
 // [ZZ] this is the object that's used for ZScript
 class DLineTracer : public DObject
 {
@@ -137,6 +137,8 @@ static player_t PredictionPlayerBackup;
 static AActor *PredictionActor;
 static TArray<uint8_t> PredictionActorBackupArray;
 static TArray<AActor *> PredictionSectorListBackup;
+static TArray<FBlockThing> PredictionBlockThingsBackup;
+static TArray<int> PredictionBlockIndexBackup;
 
 static TArray<sector_t *> PredictionTouchingSectorsBackup;
 static TArray<msecnode_t *> PredictionTouchingSectors_sprev_Backup;
@@ -1438,16 +1440,20 @@ void P_PredictPlayer (player_t *player)
 	}
 
 	// Blockmap ordering also needs to stay the same, so unlink the block nodes
-	// without releasing them. (They will be used again in P_UnpredictPlayer).
+	// without releasing them and remember where they were. (They will be used again in P_UnpredictPlayer).
 	FBlockNode *block = act->BlockNode;
 
+	PredictionBlockThingsBackup.Clear();
+	PredictionBlockIndexBackup.Clear();
 	while (block != NULL)
 	{
-		if (block->NextActor != NULL)
+		FBlockThing entry;
+		int index = act->Level->blockmap.UnlinkThing(block, &entry);
+		if (index >= 0)
 		{
-			block->NextActor->PrevActor = block->PrevActor;
+			PredictionBlockThingsBackup.Push(entry);
+			PredictionBlockIndexBackup.Push(index);
 		}
-		*(block->PrevActor) = block->NextActor;
 		block = block->NextBlock;
 	}
 	act->BlockNode = NULL;
@@ -1581,17 +1587,10 @@ void P_UnPredictPlayer ()
 			act->touching_lineportallist = RestoreNodeList(act, lineportal_list, &FLinePortal::lineportal_thinglist, PredictionPortalLines_sprev_Backup, PredictionPortalLinesBackup);
 		}
 
-		// Now fix the pointers in the blocknode chain
-		FBlockNode *block = act->BlockNode;
-
-		while (block != NULL)
+		// Now put the block nodes back where they were, in reverse order of removal.
+		for (unsigned i = PredictionBlockThingsBackup.Size(); i-- > 0; )
 		{
-			*(block->PrevActor) = block;
-			if (block->NextActor != NULL)
-			{
-				block->NextActor->PrevActor = &block->NextActor;
-			}
-			block = block->NextBlock;
+			act->Level->blockmap.RelinkThing(PredictionBlockThingsBackup[i], PredictionBlockIndexBackup[i]);
 		}
 
 		actInvSel = InvSel;
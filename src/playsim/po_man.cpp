@@ -1028,7 +1028,6 @@ void FPolyObj::UnLinkPolyobj ()
 bool FPolyObj::CheckMobjBlocking (side_t *sd)
 {
 	static TArray<AActor *> checker;
-	FBlockNode *block;
 	AActor *mobj;
 	int i, j, k;
 	int left, right, top, bottom;
@@ -1061,9 +1060,12 @@ bool FPolyObj::CheckMobjBlocking (side_t *sd)
 	{
 		for (i = left; i <= right; i++)
 		{
-			for (block = Level->blockmap.blocklinks[j+i]; block != nullptr; block = block->NextActor)
+			auto &things = Level->blockmap.blockthings[j+i];
+			for (unsigned b = things.Size(); b-- > 0; )
 			{
-				mobj = block->Me;
+				// P_TryMove below may relink things so the index needs to be revalidated.
+				if (b >= things.Size()) continue;
+				mobj = things[b].Me;
 				for (k = (int)checker.Size()-1; k >= 0; --k)
 				{
 					if (checker[k] == mobj)
@@ -1161,6 +1163,9 @@ void FPolyObj::LinkPolyobj ()
 	int bmapwidth = Level->blockmap.bmapwidth;
 	int bmapheight = Level->blockmap.bmapheight;
 
+	// actors may have cached that this polyobject's new area is empty.
+	P_InvalidateSecNodeCaches();
+
 	// calculate the polyobj bbox
 	Bounds.ClearBox();
 	for(unsigned i = 0; i < Sidedefs.Size(); i++)
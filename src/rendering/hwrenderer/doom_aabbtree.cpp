@@ -22,8 +22,12 @@
 
 
 
+#include <random>
 #include "doom_aabbtree.h"
 #include "g_levellocals.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "i_time.h"
 
 using namespace hwrenderer;
 
@@ -76,6 +80,8 @@ DoomLevelAABBTree::DoomLevelAABBTree(FLevelLocals *lev)
 		treeline.dx = (float)line.v2->fX() - treeline.x;
 		treeline.dy = (float)line.v2->fY() - treeline.y;
 	}
+
+	FinishTree();
 }
 
 bool DoomLevelAABBTree::GenerateTree(const FVector2 *centroids, bool dynamicsubtree)
@@ -128,34 +134,8 @@ bool DoomLevelAABBTree::Update()
 
 		if (memcmp(&treelines[i], &treeline, sizeof(AABBTreeLine)))
 		{
-			TArray<int> path = FindNodePath(i, nodes.Size() - 1);
-			if (path.Size())
-			{
-				float x1 = (float)line.v1->fX();
-				float y1 = (float)line.v1->fY();
-				float x2 = (float)line.v2->fX();
-				float y2 = (float)line.v2->fY();
-
-				int nodeIndex = path[0];
-				nodes[nodeIndex].aabb_left = min(x1, x2);
-				nodes[nodeIndex].aabb_right = max(x1, x2);
-				nodes[nodeIndex].aabb_top = min(y1, y2);
-				nodes[nodeIndex].aabb_bottom = max(y1, y2);
-
-				for (unsigned int j = 1; j < path.Size(); j++)
-				{
-					auto &cur = nodes[path[j]];
-					const auto &left = nodes[cur.left_node];
-					const auto &right = nodes[cur.right_node];
-					cur.aabb_left = min(left.aabb_left, right.aabb_left);
-					cur.aabb_top = min(left.aabb_top, right.aabb_top);
-					cur.aabb_right = max(left.aabb_right, right.aabb_right);
-					cur.aabb_bottom = max(left.aabb_bottom, right.aabb_bottom);
-				}
-
-				treelines[i] = treeline;
-				modified = true;
-			}
+			RefitLine(i, treeline);
+			modified = true;
 		}
 	}
 	return modified;
@@ -271,3 +251,53 @@ int DoomLevelAABBTree::GenerateTreeNode(int *lines, int num_lines, const FVector
 	return (int)nodes.Size() - 1;
 }
 
+
+//==========================================================================
+//
+// Compares the ray test variants on the current level. The rays are
+// shaped like the shadow map tests: they start near a random vertex and
+// reach up to a typical light radius in a random direction.
+//
+//==========================================================================
+
+CCMD(gl_aabbtreebench)
+{
+	auto tree = primaryLevel->aabbTree;
+	if (tree == nullptr || primaryLevel->vertexes.Size() == 0)
+	{
+		Printf("No level loaded\n");
+		return;
+	}
+
+	const int packetsize = LevelAABBTree::RayPacketSize;
+	int numrays = argv.argc() > 1 ? atoi(argv[1]) : 100000;
+	numrays = max(packetsize, numrays / packetsize * packetsize);
+
+	std::minstd_rand rng(numrays);
+	std::uniform_real_distribution<double> offset(-256., 256.), angle(0., 360.), length(16., 512.);
+	TArray<DVector3> starts(numrays, true), ends(numrays, true);
+	for (int i = 0; i < numrays; i++)
+	{
+		auto &v = primaryLevel->vertexes[rng() % primaryLevel->vertexes.Size()];
+		starts[i] = DVector3(v.fX() + offset(rng), v.fY() + offset(rng), 0.);
+		ends[i] = starts[i] + DVector3(DAngle::fromDeg(angle(rng)).ToVector(length(rng)), 0.);
+	}
+
+	TArray<double> reference(numrays, true), flat(numrays, true), packet(numrays, true);
+	uint64_t time0 = I_nsTime();
+	for (int i = 0; i < numrays; i++) reference[i] = tree->RayTestNodes(starts[i], ends[i]);
+	uint64_t time1 = I_nsTime();
+	for (int i = 0; i < numrays; i++) flat[i] = tree->RayTest(starts[i], ends[i]);
+	uint64_t time2 = I_nsTime();
+	for (int i = 0; i < numrays; i += packetsize) tree->RayTestPacket(&starts[i], &ends[i], packetsize, &packet[i]);
+	uint64_t time3 = I_nsTime();
+
+	int mismatches = 0, hits = 0;
+	for (int i = 0; i < numrays; i++)
+	{
+		if (flat[i] != reference[i] || packet[i] != reference[i]) mismatches++;
+		if (reference[i] < 1.0) hits++;
+	}
+	Printf("%d rays, %d hits, %u nodes: node tree %.2f ms, flattened %.2f ms, packets of %d %.2f ms, %d mismatches\n",
+		numrays, hits, tree->NodesCount(), (time1 - time0) / 1e6, (time2 - time1) / 1e6, packetsize, (time3 - time2) / 1e6, mismatches);
+}
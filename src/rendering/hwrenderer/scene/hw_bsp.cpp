@@ -217,6 +217,7 @@ EXTERN_CVAR(Bool, gl_render_segs)
 CVAR(Bool, gl_render_things, true, 0)
 CVAR(Bool, gl_render_walls, true, 0)
 CVAR(Bool, gl_render_flats, true, 0)
+CVAR(Bool, gl_spriteprecull, true, 0)
 
 void HWDrawInfo::UnclipSubsector(subsector_t *sub)
 {
@@ -513,6 +514,100 @@ void HWDrawInfo::AddSpecialPortalLines(subsector_t * sub, sector_t * sector, lin
 }
 
 
+//==========================================================================
+//
+// Returns a radius around the sprite's origin that encloses all rotations
+// of the given sprite frame, no matter how it gets rolled or flattened.
+//
+//==========================================================================
+
+static TArray<float> SpriteFrameRadius;
+
+static float GetSpriteFrameRadius(unsigned index)
+{
+	if (SpriteFrameRadius.Size() != SpriteFrames.Size())
+	{
+		SpriteFrameRadius.Resize(SpriteFrames.Size());
+		for (auto &r : SpriteFrameRadius) r = -1.f;
+	}
+	float &radius = SpriteFrameRadius[index];
+	if (radius < 0)
+	{
+		radius = 0;
+		for (auto texid : SpriteFrames[index].Texture)
+		{
+			auto tex = TexMan.GetGameTexture(texid);
+			if (tex == nullptr) continue;
+			float w = tex->GetDisplayWidth(), h = tex->GetDisplayHeight();
+			for (int adjusted = 0; adjusted < 2; adjusted++)
+			{
+				float left = tex->GetDisplayLeftOffset(adjusted), top = tex->GetDisplayTopOffset(adjusted);
+				float dx = max(fabsf(left), fabsf(w - left));
+				float dy = max(fabsf(top), fabsf(h - top));
+				radius = max(radius, sqrtf(dx * dx + dy * dy));
+			}
+		}
+	}
+	return radius;
+}
+
+//==========================================================================
+//
+// Rejects things whose sprites lie entirely in the clipper's covered
+// angles before the worker ever sees them. This must run before the
+// subsector's own lines get clipped, because everything in the clipper
+// at that point is in front of the sector's contents. The clipper also
+// contains the range outside the horizontal view frustum.
+//
+// Models, voxels, players and picnum overrides can't be sized without
+// going through the full setup, so they are always processed, as are
+// sprites that reach out of the thing's render radius.
+//
+//==========================================================================
+
+void HWDrawInfo::PreCullThings(sector_t *sector)
+{
+	auto &clipper = *mClipper;
+	const auto &vp = Viewpoint;
+	double pixelstretch = Level->info->pixelstretch;
+
+	for (auto p = sector->touching_renderthings; p != nullptr; p = p->m_snext)
+	{
+		auto thing = p->m_thing;
+		// Only decide once per scene. The sprite job of an earlier sector may already be reading the result.
+		if (thing->spritecullcount == validcount) continue;
+
+		bool culled = false;
+		if (gl_spriteprecull && !thing->hasmodel && !thing->picnum.isValid() && thing->player == nullptr &&
+			thing->sprite > 0 && thing->sprite < (int)sprites.Size() && thing->frame < sprites[thing->sprite].numframes)
+		{
+			unsigned frameindex = sprites[thing->sprite].spriteframes + thing->frame;
+			if (SpriteFrames[frameindex].Voxel == nullptr)
+			{
+				double scale = max(fabs(thing->Scale.X), fabs(thing->Scale.Y) * pixelstretch);
+				double radius = GetSpriteFrameRadius(frameindex) * scale + thing->SpriteOffset.Length();
+				DVector3 pos = thing->InterpolatedPosition(vp.TicFrac) + thing->WorldOffset;
+				double renderradius = thing->RenderRadius();
+
+				// Everything in the clipper is only known to be in front of the sectors the thing is linked
+				// into, and those only cover its render radius. So the sprite has to fit into that.
+				if ((pos.XY() - thing->Pos().XY()).Length() + radius * 1.1 + 4 <= renderradius)
+				{
+					float box[4];
+					box[BOXTOP] = float(thing->Y() + renderradius);
+					box[BOXBOTTOM] = float(thing->Y() - renderradius);
+					box[BOXLEFT] = float(thing->X() - renderradius);
+					box[BOXRIGHT] = float(thing->X() + renderradius);
+					culled = !clipper.CheckBox(box);
+				}
+			}
+		}
+		if (culled) render_spriteculled++;
+		thing->spriteculled = culled;
+		thing->spritecullcount = validcount;
+	}
+}
+
 //==========================================================================
 //
 // R_RenderThings
@@ -529,6 +624,7 @@ void HWDrawInfo::RenderThings(subsector_t * sub, sector_t * sector)
 		auto thing = p->m_thing;
 		if (thing->validcount == validcount) continue;
 		thing->validcount = validcount;
+		if (thing->spritecullcount == validcount && thing->spriteculled) continue;
 
 		FIntCVar *cvar = thing->GetInfo()->distancecheck;
 		if (cvar != nullptr && *cvar >= 0)
@@ -544,6 +640,7 @@ void HWDrawInfo::RenderThings(subsector_t * sub, sector_t * sector)
 		if (CurrentMapSections[thing->subsector->mapsection])
 		{
 			HWSprite sprite;
+			render_spriteprocessed++;
 
 			// [Nash] draw sprite shadow
 			if (R_ShouldDrawSpriteShadow(thing))
@@ -660,6 +757,8 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 		}
 	}
 
+	ss_visitorder[sub->Index()] = ++subsectorsvisited;
+
 	if (sector->validcount != validcount)
 	{
 		CheckUpdate(screen->mVertexData, sector);
@@ -680,6 +779,11 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 		}
 	}
 
+	if (gl_render_things && sector->validcount != validcount && sector->touching_renderthings)
+	{
+		PreCullThings(sector);
+	}
+
 	AddLines(sub, fakesector);
 
 	// BSP is traversed by subsector.
@@ -48,77 +48,49 @@ Clipper::Clipper()
 
 //-----------------------------------------------------------------------------
 //
-// RemoveRange
+// Clear
 //
 //-----------------------------------------------------------------------------
 
-void Clipper::RemoveRange(ClipNode * range)
+void Clipper::Clear()
 {
-	if (range == cliphead)
-	{
-		cliphead = cliphead->next;
-	}
-	else
-	{
-		if (range->prev) range->prev->next = range->next;
-		if (range->next) range->next->prev = range->prev;
-	}
-	
-	Free(range);
+	blocked = false;
+	ranges.Clear();
+	silhouette.Clear();
+	starttime++;
 }
 
 //-----------------------------------------------------------------------------
 //
-// Clear
+// SetSilhouette
 //
 //-----------------------------------------------------------------------------
 
-void Clipper::Clear()
+void Clipper::SetSilhouette()
 {
-	ClipNode *node = cliphead;
-	ClipNode *temp;
-	
-	blocked = false;
-	while (node != NULL)
-	{
-		temp = node;
-		node = node->next;
-		Free(temp);
-	}
-	node = silhouette;
-
-	while (node != NULL)
+	if (silhouette.Size() == 0)
 	{
-		temp = node;
-		node = node->next;
-		Free(temp);
+		silhouette = ranges;
 	}
-	
-	cliphead = NULL;
-	silhouette = NULL;
-	starttime++;
 }
 
 //-----------------------------------------------------------------------------
 //
-// SetSilhouette
+// FindRange
+// Returns the index of the first range that ends at or after the given angle.
 //
 //-----------------------------------------------------------------------------
 
-void Clipper::SetSilhouette()
+unsigned Clipper::FindRange(angle_t angle) const
 {
-	ClipNode *node = cliphead;
-	ClipNode *last = NULL;
-
-	while (node != NULL)
+	unsigned lo = 0, hi = ranges.Size();
+	while (lo < hi)
 	{
-		ClipNode *snode = NewRange(node->start, node->end);
-		if (silhouette == NULL) silhouette = snode;
-		snode->prev = last;
-		if (last != NULL) last->next = snode;
-		last = snode;
-		node = node->next;
+		unsigned mid = (lo + hi) >> 1;
+		if (ranges[mid].end < angle) lo = mid + 1;
+		else hi = mid;
 	}
+	return lo;
 }
 
 //-----------------------------------------------------------------------------
@@ -129,20 +101,19 @@ void Clipper::SetSilhouette()
 
 bool Clipper::IsRangeVisible(angle_t startAngle, angle_t endAngle)
 {
-	ClipNode *ci;
-	ci = cliphead;
-	
-	if (endAngle==0 && ci && ci->start==0) return false;
-	
-	while (ci != NULL && ci->start < endAngle)
+	if (ranges.Size() == 0) return true;
+	if (endAngle == 0 && ranges[0].start == 0) return false;
+
+	// Only the range ending at or after the start can contain the whole query.
+	unsigned i = FindRange(startAngle);
+	if (i < ranges.Size())
 	{
-		if (startAngle >= ci->start && endAngle <= ci->end)
+		auto &range = ranges[i];
+		if (range.start < endAngle && startAngle >= range.start && endAngle <= range.end)
 		{
 			return false;
 		}
-		ci = ci->next;
 	}
-	
 	return true;
 }
 
@@ -154,99 +125,28 @@ bool Clipper::IsRangeVisible(angle_t startAngle, angle_t endAngle)
 
 void Clipper::AddClipRange(angle_t start, angle_t end)
 {
-	ClipNode *node, *temp, *prevNode;
+	unsigned i = FindRange(start);
 
-	if (cliphead)
+	if (i < ranges.Size() && ranges[i].start <= end)
 	{
-		//check to see if range contains any old ranges
-		node = cliphead;
-		while (node != NULL && node->start < end)
-		{
-			if (node->start >= start && node->end <= end)
-			{
-				temp = node;
-				node = node->next;
-				RemoveRange(temp);
-			}
-			else if (node->start<=start && node->end>=end)
-			{
-				return;
-			}
-			else
-			{
-				node = node->next;
-			}
-		}
-		
-		//check to see if range overlaps a range (or possibly 2)
-		node = cliphead;
-		while (node != NULL && node->start <= end)
-		{
-			if (node->end >= start)
-			{
-				// we found the first overlapping node
-				if (node->start > start)
-				{
-					// the new range overlaps with this node's start point
-					node->start = start;
-				}
-
-				if (node->end < end) 
-				{
-					node->end = end;
-				}
-
-				ClipNode *node2 = node->next;
-				while (node2 && node2->start <= node->end)
-				{
-					if (node2->end > node->end) node->end = node2->end;
-					ClipNode *delnode = node2;
-					node2 = node2->next;
-					RemoveRange(delnode);
-				}
-				return;
-			}
-			node = node->next;		
-		}
-		
-		//just add range
-		node = cliphead;
-		prevNode = NULL;
-		temp = NewRange(start, end);
-		
-		while (node != NULL && node->start < end)
-		{
-			prevNode = node;
-			node = node->next;
-		}
-		
-		temp->next = node;
-		if (node == NULL)
-		{
-			temp->prev = prevNode;
-			if (prevNode) prevNode->next = temp;
-			if (!cliphead) cliphead = temp;
-		}
-		else
+		// Overlaps or touches this range and possibly some following ones.
+		auto &range = ranges[i];
+		if (range.start <= start && range.end >= end) return;
+
+		range.start = min(range.start, start);
+		range.end = max(range.end, end);
+
+		unsigned j = i + 1;
+		while (j < ranges.Size() && ranges[j].start <= range.end)
 		{
-			if (node == cliphead)
-			{
-				cliphead->prev = temp;
-				cliphead = temp;
-			}
-			else
-			{
-				temp->prev = prevNode;
-				prevNode->next = temp;
-				node->prev = temp;
-			}
+			range.end = max(range.end, ranges[j].end);
+			j++;
 		}
+		if (j > i + 1) ranges.Delete(i + 1, j - i - 1);
 	}
 	else
 	{
-		temp = NewRange(start, end);
-		cliphead = temp;
-		return;
+		ranges.Insert(i, { start, end });
 	}
 }
 
@@ -259,26 +159,24 @@ void Clipper::AddClipRange(angle_t start, angle_t end)
 
 void Clipper::RemoveClipRange(angle_t start, angle_t end)
 {
-	ClipNode *node;
-
-	if (silhouette)
+	if (silhouette.Size() > 0)
 	{
-		node = silhouette;
-		while (node != NULL && node->end <= start)
+		unsigned i = 0;
+		while (i < silhouette.Size() && silhouette[i].end <= start)
 		{
-			node = node->next;
+			i++;
 		}
-		if (node != NULL && node->start <= start)
+		if (i < silhouette.Size() && silhouette[i].start <= start)
 		{
-			if (node->end >= end) return;
-			start = node->end;
-			node = node->next;
+			if (silhouette[i].end >= end) return;
+			start = silhouette[i].end;
+			i++;
 		}
-		while (node != NULL && node->start < end)
+		while (i < silhouette.Size() && silhouette[i].start < end)
 		{
-			DoRemoveClipRange(start, node->start);
-			start = node->end;
-			node = node->next;
+			DoRemoveClipRange(start, silhouette[i].start);
+			start = silhouette[i].end;
+			i++;
 		}
 		if (start >= end) return;
 	}
@@ -293,51 +191,41 @@ void Clipper::RemoveClipRange(angle_t start, angle_t end)
 
 void Clipper::DoRemoveClipRange(angle_t start, angle_t end)
 {
-	ClipNode *node, *temp;
+	// Removing an empty range used to split a range into two touching halves,
+	// which made everything spanning the split point visible.
+	if (start >= end) return;
 
-	if (cliphead)
+	// Ranges ending before the start are not affected.
+	for (unsigned i = FindRange(start); i < ranges.Size(); )
 	{
-		//check to see if range contains any old ranges
-		node = cliphead;
-		while (node != NULL && node->start < end)
+		auto &range = ranges[i];
+		if (range.start > end)
+		{
+			break;
+		}
+		else if (range.start >= start && range.end <= end && range.start < end)
 		{
-			if (node->start >= start && node->end <= end)
-			{
-				temp = node;
-				node = node->next;
-				RemoveRange(temp);
-			}
-			else
-			{
-				node = node->next;
-			}
+			ranges.Delete(i);
+			continue;
 		}
-		
-		//check to see if range overlaps a range (or possibly 2)
-		node = cliphead;
-		while (node != NULL)
+		else if (range.start >= start)
 		{
-			if (node->start >= start && node->start <= end)
-			{
-				node->start = end;
-				break;
-			}
-			else if (node->end >= start && node->end <= end)
-			{
-				node->end=start;
-			}
-			else if (node->start < start && node->end > end)
-			{
-				temp = NewRange(end, node->end);
-				node->end=start;
-				temp->next=node->next;
-				temp->prev=node;
-				node->next=temp;
-				if (temp->next) temp->next->prev=temp;
-				break;
-			}
-			node = node->next;
+			range.start = end;
+			break;
 		}
+		else if (range.end <= end)
+		{
+			range.end = start;
+		}
+		else
+		{
+			// The removed range is in the middle of this one.
+			ClipRange back = { end, range.end };
+			range.end = start;
+			ranges.Insert(i + 1, back);
+			break;
+		}
+		i++;
 	}
 }
 
@@ -440,4 +328,3 @@ bool Clipper::CheckBox(const float *bspcoord)
 	
 	return SafeCheckRange(angle2, angle1);
 }
-
@@ -0,0 +1,450 @@
+/*
+*
+** hw_clippertest.cpp
+**
+** Compares the clipper against the linked list implementation it replaced.
+** Only built into debug builds.
+**
+**---------------------------------------------------------------------------
+** Copyright 2003 Tim Stump
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+#ifdef _DEBUG
+
+#include "hw_clipper.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "i_time.h"
+#include "memarena.h"
+#include <random>
+
+//-----------------------------------------------------------------------------
+//
+// The linked list clipper the range array replaced. It is only kept as the
+// reference for gl_clippertest, so apart from the class and node names the
+// code below is unchanged, with one exception: empty removals are ignored,
+// like in Clipper::DoRemoveClipRange. The old code left a pair of touching
+// nodes behind for them, which is the one intended difference.
+//
+//-----------------------------------------------------------------------------
+
+class FLegacyClipper
+{
+	struct ClipNode
+	{
+		ClipNode *prev, *next;
+		angle_t start, end;
+	};
+
+	FMemArena nodearena;
+	ClipNode * freelist = nullptr;
+
+	ClipNode * cliphead = nullptr;
+	ClipNode * silhouette = nullptr;	// will be preserved even when RemoveClipRange is called
+
+	void RemoveRange(ClipNode * cn);
+	void DoRemoveClipRange(angle_t start, angle_t end);
+
+	void Free(ClipNode *node)
+	{
+		node->next = freelist;
+		freelist = node;
+	}
+
+	ClipNode * GetNew()
+	{
+		if (freelist)
+		{
+			ClipNode * p = freelist;
+			freelist = p->next;
+			return p;
+		}
+		else return (ClipNode*)nodearena.Alloc(sizeof(ClipNode));
+	}
+
+	ClipNode * NewRange(angle_t start, angle_t end)
+	{
+		ClipNode * c = GetNew();
+
+		c->start = start;
+		c->end = end;
+		c->next = c->prev = NULL;
+		return c;
+	}
+
+public:
+	void Clear();
+	void SetSilhouette();
+	bool IsRangeVisible(angle_t startangle, angle_t endangle);
+	void AddClipRange(angle_t startangle, angle_t endangle);
+	void RemoveClipRange(angle_t startangle, angle_t endangle);
+
+	bool Matches(const TArray<ClipRange> &ranges) const
+	{
+		unsigned i = 0;
+		for (ClipNode *node = cliphead; node != NULL; node = node->next, i++)
+		{
+			if (i >= ranges.Size() || ranges[i].start != node->start || ranges[i].end != node->end) return false;
+		}
+		return i == ranges.Size();
+	}
+};
+
+void FLegacyClipper::RemoveRange(ClipNode * range)
+{
+	if (range == cliphead)
+	{
+		cliphead = cliphead->next;
+	}
+	else
+	{
+		if (range->prev) range->prev->next = range->next;
+		if (range->next) range->next->prev = range->prev;
+	}
+	
+	Free(range);
+}
+
+void FLegacyClipper::Clear()
+{
+	ClipNode *node = cliphead;
+	ClipNode *temp;
+	
+	while (node != NULL)
+	{
+		temp = node;
+		node = node->next;
+		Free(temp);
+	}
+	node = silhouette;
+
+	while (node != NULL)
+	{
+		temp = node;
+		node = node->next;
+		Free(temp);
+	}
+	
+	cliphead = NULL;
+	silhouette = NULL;
+}
+
+void FLegacyClipper::SetSilhouette()
+{
+	ClipNode *node = cliphead;
+	ClipNode *last = NULL;
+
+	while (node != NULL)
+	{
+		ClipNode *snode = NewRange(node->start, node->end);
+		if (silhouette == NULL) silhouette = snode;
+		snode->prev = last;
+		if (last != NULL) last->next = snode;
+		last = snode;
+		node = node->next;
+	}
+}
+
+bool FLegacyClipper::IsRangeVisible(angle_t startAngle, angle_t endAngle)
+{
+	ClipNode *ci;
+	ci = cliphead;
+	
+	if (endAngle==0 && ci && ci->start==0) return false;
+	
+	while (ci != NULL && ci->start < endAngle)
+	{
+		if (startAngle >= ci->start && endAngle <= ci->end)
+		{
+			return false;
+		}
+		ci = ci->next;
+	}
+	
+	return true;
+}
+
+void FLegacyClipper::AddClipRange(angle_t start, angle_t end)
+{
+	ClipNode *node, *temp, *prevNode;
+
+	if (cliphead)
+	{
+		//check to see if range contains any old ranges
+		node = cliphead;
+		while (node != NULL && node->start < end)
+		{
+			if (node->start >= start && node->end <= end)
+			{
+				temp = node;
+				node = node->next;
+				RemoveRange(temp);
+			}
+			else if (node->start<=start && node->end>=end)
+			{
+				return;
+			}
+			else
+			{
+				node = node->next;
+			}
+		}
+		
+		//check to see if range overlaps a range (or possibly 2)
+		node = cliphead;
+		while (node != NULL && node->start <= end)
+		{
+			if (node->end >= start)
+			{
+				// we found the first overlapping node
+				if (node->start > start)
+				{
+					// the new range overlaps with this node's start point
+					node->start = start;
+				}
+
+				if (node->end < end) 
+				{
+					node->end = end;
+				}
+
+				ClipNode *node2 = node->next;
+				while (node2 && node2->start <= node->end)
+				{
+					if (node2->end > node->end) node->end = node2->end;
+					ClipNode *delnode = node2;
+					node2 = node2->next;
+					RemoveRange(delnode);
+				}
+				return;
+			}
+			node = node->next;		
+		}
+		
+		//just add range
+		node = cliphead;
+		prevNode = NULL;
+		temp = NewRange(start, end);
+		
+		while (node != NULL && node->start < end)
+		{
+			prevNode = node;
+			node = node->next;
+		}
+		
+		temp->next = node;
+		if (node == NULL)
+		{
+			temp->prev = prevNode;
+			if (prevNode) prevNode->next = temp;
+			if (!cliphead) cliphead = temp;
+		}
+		else
+		{
+			if (node == cliphead)
+			{
+				cliphead->prev = temp;
+				cliphead = temp;
+			}
+			else
+			{
+				temp->prev = prevNode;
+				prevNode->next = temp;
+				node->prev = temp;
+			}
+		}
+	}
+	else
+	{
+		temp = NewRange(start, end);
+		cliphead = temp;
+		return;
+	}
+}
+
+void FLegacyClipper::RemoveClipRange(angle_t start, angle_t end)
+{
+	ClipNode *node;
+
+	if (silhouette)
+	{
+		node = silhouette;
+		while (node != NULL && node->end <= start)
+		{
+			node = node->next;
+		}
+		if (node != NULL && node->start <= start)
+		{
+			if (node->end >= end) return;
+			start = node->end;
+			node = node->next;
+		}
+		while (node != NULL && node->start < end)
+		{
+			DoRemoveClipRange(start, node->start);
+			start = node->end;
+			node = node->next;
+		}
+		if (start >= end) return;
+	}
+	DoRemoveClipRange(start, end);
+}
+
+void FLegacyClipper::DoRemoveClipRange(angle_t start, angle_t end)
+{
+	ClipNode *node, *temp;
+
+	if (start >= end) return;	// see above
+
+	if (cliphead)
+	{
+		//check to see if range contains any old ranges
+		node = cliphead;
+		while (node != NULL && node->start < end)
+		{
+			if (node->start >= start && node->end <= end)
+			{
+				temp = node;
+				node = node->next;
+				RemoveRange(temp);
+			}
+			else
+			{
+				node = node->next;
+			}
+		}
+		
+		//check to see if range overlaps a range (or possibly 2)
+		node = cliphead;
+		while (node != NULL)
+		{
+			if (node->start >= start && node->start <= end)
+			{
+				node->start = end;
+				break;
+			}
+			else if (node->end >= start && node->end <= end)
+			{
+				node->end=start;
+			}
+			else if (node->start < start && node->end > end)
+			{
+				temp = NewRange(end, node->end);
+				node->end=start;
+				temp->next=node->next;
+				temp->prev=node;
+				node->next=temp;
+				if (temp->next) temp->next->prev=temp;
+				break;
+			}
+			node = node->next;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+//
+// Runs the same random operations on both clippers and compares the
+// resulting ranges and visibility checks. The angles often share endpoints
+// or produce empty ranges, and some rounds set a silhouette part way through.
+//
+//-----------------------------------------------------------------------------
+
+struct FClipperTest
+{
+	Clipper clipper;
+	FLegacyClipper reference;
+
+	int Run(int iterations)
+	{
+		std::minstd_rand rng(iterations);
+		auto randomangle = [&]() -> angle_t
+		{
+			// Snap most angles to a coarse grid so that ranges frequently share endpoints.
+			unsigned r = rng();
+			return (r & 3) ? (angle_t)((r >> 2) % 65) * (ANGLE_MAX / 64) : (angle_t)(r * 2654435761u);
+		};
+
+		int failures = 0;
+		int silhouette = -1;
+		for (int i = 0; i < iterations; i++)
+		{
+			if ((i & 255) == 0)
+			{
+				clipper.Clear();
+				reference.Clear();
+				silhouette = (rng() % 3 == 0) ? int(rng() % 256) : -1;
+			}
+			if ((i & 255) == silhouette)
+			{
+				clipper.SetSilhouette();
+				reference.SetSilhouette();
+			}
+			angle_t a = randomangle(), b = randomangle();
+			if (a > b) std::swap(a, b);
+
+			switch (rng() % 3)
+			{
+			case 0:
+				clipper.AddClipRange(a, b);
+				reference.AddClipRange(a, b);
+				break;
+
+			case 1:
+				clipper.RemoveClipRange(a, b);
+				reference.RemoveClipRange(a, b);
+				break;
+
+			case 2:
+				if (clipper.IsRangeVisible(a, b) != reference.IsRangeVisible(a, b)) failures++;
+				break;
+			}
+			if (!reference.Matches(clipper.ranges))
+			{
+				// Start over, the states can't be compared anymore.
+				failures++;
+				clipper.Clear();
+				reference.Clear();
+				silhouette = -1;
+			}
+		}
+		return failures;
+	}
+};
+
+CCMD(gl_clippertest)
+{
+	int iterations = argv.argc() > 1 ? max(1, atoi(argv[1])) : 1000000;
+	FClipperTest test;
+	uint64_t start = I_nsTime();
+	int failures = test.Run(iterations);
+	Printf("%d clipper operations tested in %.2f ms, %d mismatches\n", iterations, (I_nsTime() - start) / 1e6, failures);
+}
+
+#endif
@@ -224,6 +224,7 @@ void HWDrawInfo::ClearBuffers()
 	//FloorStacks.Clear();
 	HandledSubsectors.Clear();
 	spriteindex = 0;
+	subsectorsvisited = 0;
 
 	if (Level)
 	{
@@ -233,10 +234,12 @@ void HWDrawInfo::ClearBuffers()
 		section_renderflags.Resize(Level->sections.allSections.Size());
 		ss_renderflags.Resize(Level->subsectors.Size());
 		no_renderflags.Resize(Level->subsectors.Size());
+		ss_visitorder.Resize(Level->subsectors.Size());
 
 		memset(&section_renderflags[0], 0, Level->sections.allSections.Size() * sizeof(section_renderflags[0]));
 		memset(&ss_renderflags[0], 0, Level->subsectors.Size() * sizeof(ss_renderflags[0]));
 		memset(&no_renderflags[0], 0, Level->nodes.Size() * sizeof(no_renderflags[0]));
+		memset(&ss_visitorder[0], 0, Level->subsectors.Size() * sizeof(ss_visitorder[0]));
 	}
 
 	Decals[0].Clear();
@@ -175,6 +175,8 @@ struct HWDrawInfo
 	TArray<uint8_t> section_renderflags;
 	TArray<uint8_t> ss_renderflags;
 	TArray<uint8_t> no_renderflags;
+	TArray<int> ss_visitorder;	// front to back position of each subsector in the BSP traversal, 0 if not reached
+	int subsectorsvisited;
 
 	// This is needed by the BSP traverser.
 	BitArray CurrentMapSections;	// this cannot be a single number, because a group of portals with the same displacement may link different sections.
@@ -202,6 +204,7 @@ private:
 	void AddLines(subsector_t * sub, sector_t * sector);
 	void AddSpecialPortalLines(subsector_t * sub, sector_t * sector, linebase_t *line);
 	public:
+	void PreCullThings(sector_t *sector);
 	void RenderThings(subsector_t * sub, sector_t * sector);
 	void RenderParticles(subsector_t *sub, sector_t *front);
 	void DoSubsector(subsector_t * sub);
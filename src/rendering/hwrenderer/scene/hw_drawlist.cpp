@@ -37,6 +37,11 @@
 #include "hw_renderstate.h"
 #include "hw_drawinfo.h"
 #include "hw_fakeflat.h"
+#include "hw_dynlightdata.h"
+#include "v_video.h"
+
+CVAR(Bool, gl_batchflats, true, 0)
+CVAR(Bool, gl_binnedsort, true, 0)
 
 FMemArena RenderDataAllocator(1024*1024);	// Use large blocks to reduce allocation time.
 
@@ -279,6 +284,7 @@ void HWDrawList::SortWallIntoPlane(HWDrawInfo* di, SortNode * head, SortNode * s
 	{
 		// We have to split this wall!
 
+		render_sortsplit++;
 		HWWall *w = NewWall();
 		*w = *ws;
 
@@ -344,6 +350,7 @@ void HWDrawList::SortSpriteIntoPlane(SortNode * head, SortNode * sort)
 	if ((hiz > fh->z && loz < fh->z) || ss->modelframe)
 	{
 		// We have to split this sprite
+		render_sortsplit++;
 		HWSprite *s = NewSprite();
 		*s = *ss;
 
@@ -441,6 +448,7 @@ void HWDrawList::SortWallIntoWall(HWDrawInfo *di, SortNode * head,SortNode * sor
 		float izb=(float)(ws->zbottom[0]+r*(ws->zbottom[1]-ws->zbottom[0]));
 
 		ws->vertcount = 0;	// invalidate current vertices.
+		render_sortsplit++;
 		HWWall *w= NewWall();
 		*w = *ws;
 
@@ -546,6 +554,7 @@ void HWDrawList::SortSpriteIntoWall(HWDrawInfo *di, SortNode * head,SortNode * s
 		float iy=(float)(ss->y1 + r * (ss->y2-ss->y1));
 		float iu=(float)(ss->ul + r * (ss->ur-ss->ul));
 
+		render_sortsplit++;
 		HWSprite *s = NewSprite();
 		*s = *ss;
 
@@ -710,42 +719,223 @@ void HWDrawList::Sort(HWDrawInfo *di)
 {
 	reverseSort = !!(di->Level->i_compatflags & COMPATF_SPRITESORT);
     SortZ = di->Viewpoint.Pos.Z;
+	if (gl_binnedsort && SortByBSP(di))
+	{
+		render_sortbinned++;
+		return;
+	}
+	render_sorttree++;
 	MakeSortList();
 	sorted = DoSort(di, SortNodes[SortNodeStart]);
 }
 
 //==========================================================================
 //
-// Sorting the drawitems first by texture and then by light level
+// Alternative to the sort tree for lists containing only walls and sprites.
+//
+// Every wall is on the far side of the subsector it was processed for,
+// so drawing the subsectors in reverse BSP traversal order, each one's
+// walls first and then its sprites by depth, is already back to front.
+// This is only valid as long as nothing needs to be split and every sprite
+// lies entirely within one subsector, because sprites in different
+// subsectors are not depth sorted against each other. Translucent planes,
+// polyobjects, models and sprites crossing a translucent wall, reaching
+// out of their subsector or lying outside the traversed area make the list
+// go through the tree. So do lists without walls, for which the tree's
+// plain depth sort of the sprites is already right.
 //
 //==========================================================================
 
-void HWDrawList::SortWalls()
+struct FBinnedItem
 {
-	if (drawitems.Size() > 1)
+	int bin;
+	int itemindex;
+};
+
+static TArray<FBinnedItem> BinnedItems;
+static TArray<HWWall *> BinnedWalls;
+
+bool HWDrawList::SortByBSP(HWDrawInfo *di)
+{
+	if (flats.Size() > 0 || walls.Size() == 0) return false;
+
+	BinnedItems.Resize(drawitems.Size());
+	BinnedWalls.Clear();
+	for (unsigned i = 0; i < drawitems.Size(); i++)
 	{
-		std::sort(drawitems.begin(), drawitems.end(), [=](const HWDrawItem &a, const HWDrawItem &b) -> bool
+		int bin = 0;
+		if (drawitems[i].rendertype == DrawType_WALL)
 		{
-			HWWall * w1 = walls[a.index];
-			HWWall * w2 = walls[b.index];
+			HWWall *w = walls[drawitems[i].index];
+			if (w->seg == nullptr || w->seg->Subsector == nullptr || w->seg->sidedef == nullptr || (w->seg->sidedef->Flags & WALLF_POLYOBJ)) return false;
+			bin = di->ss_visitorder[w->seg->Subsector->Index()];
+			BinnedWalls.Push(w);
+		}
+		else
+		{
+			HWSprite *s = sprites[drawitems[i].index];
+			if (s->modelframe) return false;
+			auto sub = di->Level->PointInRenderSubsector(DVector2(s->x, s->y));
+			// Subsectors are convex, so the sprite is inside if both ends are.
+			if (di->Level->PointInRenderSubsector(DVector2(s->x1, s->y1)) != sub ||
+				di->Level->PointInRenderSubsector(DVector2(s->x2, s->y2)) != sub) return false;
+			bin = di->ss_visitorder[sub->Index()];
+		}
+		if (bin == 0) return false;
+		BinnedItems[i] = { bin, (int)i };
+	}
+
+	for (auto s : sprites)
+	{
+		float sminx = min(s->x1, s->x2), smaxx = max(s->x1, s->x2);
+		float sminy = min(s->y1, s->y2), smaxy = max(s->y1, s->y2);
+		float sminz = min(s->z1, s->z2), smaxz = max(s->z1, s->z2);
+
+		for (auto w : BinnedWalls)
+		{
+			if (max(w->glseg.x1, w->glseg.x2) < sminx || min(w->glseg.x1, w->glseg.x2) > smaxx) continue;
+			if (max(w->glseg.y1, w->glseg.y2) < sminy || min(w->glseg.y1, w->glseg.y2) > smaxy) continue;
+			if (max(w->ztop[0], w->ztop[1]) < sminz || min(w->zbottom[0], w->zbottom[1]) > smaxz) continue;
+
+			float v1 = w->PointOnSide(s->x1, s->y1);
+			float v2 = w->PointOnSide(s->x2, s->y2);
+			if ((v1 < -MIN_EQ && v2 > MIN_EQ) || (v1 > MIN_EQ && v2 < -MIN_EQ)) return false;
+		}
+	}
 
-			if (w1->texture != w2->texture) return w1->texture < w2->texture;
-			return (w1->flags & 3) < (w2->flags & 3);
+	std::sort(BinnedItems.begin(), BinnedItems.end(), [=](const FBinnedItem &a, const FBinnedItem &b)
+	{
+		if (a.bin != b.bin) return a.bin > b.bin;
+		auto &ia = drawitems[a.itemindex];
+		auto &ib = drawitems[b.itemindex];
+		if (ia.rendertype != ib.rendertype) return ia.rendertype == DrawType_WALL;
+		if (ia.rendertype == DrawType_WALL) return a.itemindex < b.itemindex;
+		HWSprite *s1 = sprites[ia.index];
+		HWSprite *s2 = sprites[ib.index];
+		if (s1->depth != s2->depth) return s1->depth > s2->depth;
+		return reverseSort ? s2->index < s1->index : s1->index < s2->index;
+	});
 
-		});
+	// The result is a single chain of equal nodes which DrawSorted draws in order.
+	SortNodeStart = SortNodes.Size();
+	SortNode *prev = nullptr;
+	for (auto &item : BinnedItems)
+	{
+		SortNode *node = SortNodes.GetNew();
+		memset(node, 0, sizeof(SortNode));
+		node->itemindex = item.itemindex;
+		if (prev) prev->equal = node;
+		else sorted = node;
+		prev = node;
 	}
+	return true;
 }
 
+//==========================================================================
+//
+// The opaque lists get sorted by a 64 bit key per item so that everything
+// using the same material ends up in one run. An LSD radix sort is stable,
+// so the low bits don't need a tie breaker, and passes over digits that are
+// the same for the entire list get skipped.
+//
+//==========================================================================
+
+struct FDrawSortItem
+{
+	uint64_t key;
+	HWDrawItem item;
+};
+
+static TArray<FDrawSortItem> SortItems, SortTemp;
+
+static void RadixSort(TArray<HWDrawItem> &drawitems)
+{
+	unsigned count = SortItems.Size();
+	uint64_t diff = 0;
+	for (unsigned i = 1; i < count; i++)
+	{
+		diff |= SortItems[i].key ^ SortItems[0].key;
+	}
+
+	SortTemp.Resize(count);
+	auto src = SortItems.Data();
+	auto dst = SortTemp.Data();
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		if (((diff >> shift) & 0xff) == 0) continue;
+
+		unsigned offsets[256] = {};
+		for (unsigned i = 0; i < count; i++)
+		{
+			offsets[(src[i].key >> shift) & 0xff]++;
+		}
+		unsigned sum = 0;
+		for (auto &offset : offsets)
+		{
+			unsigned c = offset;
+			offset = sum;
+			sum += c;
+		}
+		for (unsigned i = 0; i < count; i++)
+		{
+			dst[offsets[(src[i].key >> shift) & 0xff]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		drawitems[i] = src[i].item;
+	}
+}
+
+static uint64_t TextureSortKey(FGameTexture *tex)
+{
+	return tex == nullptr ? 0 : (tex->GetID().GetIndex() + 1) & 0xfffff;
+}
+
+//==========================================================================
+//
+// Walls are sorted by texture, then by texture clamping and light level.
+//
+//==========================================================================
+
+void HWDrawList::SortWalls()
+{
+	if (drawitems.Size() > 1)
+	{
+		SortItems.Resize(drawitems.Size());
+		for (unsigned i = 0; i < drawitems.Size(); i++)
+		{
+			HWWall *w = walls[drawitems[i].index];
+			SortItems[i].key = (TextureSortKey(w->texture) << 44) | (uint64_t(w->flags & 3) << 42) | (uint64_t(clamp<int>(w->lightlevel, 0, 255)) << 34);
+			SortItems[i].item = drawitems[i];
+		}
+		RadixSort(drawitems);
+	}
+}
+
+//==========================================================================
+//
+// Flats are sorted by texture and then by sector and index buffer position
+// so that all sections of a plane end up next to each other in the order
+// they are stored in, which allows DrawFlats to merge them into one draw.
+//
+//==========================================================================
+
 void HWDrawList::SortFlats()
 {
 	if (drawitems.Size() > 1)
 	{
-		std::sort(drawitems.begin(), drawitems.end(), [=](const HWDrawItem &a, const HWDrawItem &b)
+		SortItems.Resize(drawitems.Size());
+		for (unsigned i = 0; i < drawitems.Size(); i++)
 		{
-			HWFlat * w1 = flats[a.index];
-			HWFlat* w2 = flats[b.index];
-			return w1->texture < w2->texture;
-		});
+			HWFlat *f = flats[drawitems[i].index];
+			SortItems[i].key = (TextureSortKey(f->texture) << 44) | (uint64_t(f->sector->sectornum & 0xfffff) << 24) |
+				(uint64_t(f->ceiling) << 23) | ((f->iboindex + f->section->vertexindex) & 0x7fffff);
+			SortItems[i].item = drawitems[i];
+		}
+		RadixSort(drawitems);
 	}
 }
 
@@ -861,9 +1051,49 @@ void HWDrawList::DrawWalls(HWDrawInfo *di, FRenderState &state, bool translucent
 void HWDrawList::DrawFlats(HWDrawInfo *di, FRenderState &state, bool translucent)
 {
 	RenderFlat.Clock();
-	for (unsigned i = 0; i<drawitems.Size(); i++)
+	if (!gl_batchflats)
+	{
+		for (unsigned i = 0; i < drawitems.Size(); i++)
+		{
+			flats[drawitems[i].index]->DrawFlat(di, state, translucent);
+		}
+	}
+	else
 	{
-		flats[drawitems[i].index]->DrawFlat(di, state, translucent);
+		bool setuplights = di->Level->HasDynamicLights && screen->BuffersArePersistent() && !di->isFullbrightScene();
+		HWFlat *batch = nullptr;
+		int batchcount = 0;
+		auto flush = [&]()
+		{
+			if (batch) batch->DrawFlat(di, state, translucent, batchcount);
+			batch = nullptr;
+		};
+
+		for (auto &item : drawitems)
+		{
+			HWFlat *flat = flats[item.index];
+			if (!flat->IsBatchable())
+			{
+				flush();
+				flat->DrawFlat(di, state, translucent);
+				continue;
+			}
+
+			// Lights have to be known before merging, because lit sections need their own light index.
+			if (setuplights) flat->SetupLights(di, flat->section->lighthead, lightdata, flat->sector->PortalGroup);
+
+			if (batch && batch->CanBatchWith(flat, batchcount))
+			{
+				batchcount += flat->section->vertexcount;
+			}
+			else
+			{
+				flush();
+				batch = flat;
+				batchcount = flat->section->vertexcount;
+			}
+		}
+		flush();
 	}
 	RenderFlat.Unclock();
 }
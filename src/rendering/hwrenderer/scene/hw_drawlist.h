@@ -107,6 +107,7 @@ public:
 	int CompareSprites(SortNode * a,SortNode * b);
 	SortNode * SortSpriteList(SortNode * head);
 	SortNode * DoSort(HWDrawInfo *di, SortNode * head);
+	bool SortByBSP(HWDrawInfo *di);
 	void Sort(HWDrawInfo *di);
 
 	void DoDraw(HWDrawInfo *di, FRenderState &state, bool translucent, int i);
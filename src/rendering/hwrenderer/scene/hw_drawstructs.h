@@ -274,6 +274,7 @@ public:
 	void RenderTexturedWall(HWDrawInfo *di, FRenderState &state, int rflags);
 	void RenderTranslucentWall(HWDrawInfo *di, FRenderState &state);
 	void DrawDecalsForMirror(HWDrawInfo *di, FRenderState &state, TArray<HWDecal *> &decals);
+	void ProcessSeg(HWDrawInfo *di, seg_t *seg, sector_t *frontsector, sector_t *backsector);
 
 public:
 	void Process(HWDrawInfo *di, seg_t *seg, sector_t *frontsector, sector_t *backsector);
@@ -328,8 +329,10 @@ public:
 	void SetFrom3DFloor(F3DFloor *rover, bool top, bool underside);
 	void ProcessSector(HWDrawInfo *di, sector_t * frontsector, int which = 7 /*SSRF_RENDERALL*/);	// cannot use constant due to circular dependencies.
 	
-	void DrawSubsectors(HWDrawInfo *di, FRenderState &state);
-	void DrawFlat(HWDrawInfo *di, FRenderState &state, bool translucent);
+	bool IsBatchable() const;
+	bool CanBatchWith(HWFlat *next, int batchcount);
+	void DrawSubsectors(HWDrawInfo *di, FRenderState &state, int batchcount = -1);
+	void DrawFlat(HWDrawInfo *di, FRenderState &state, bool translucent, int batchcount = -1);
     
     void DrawOtherPlanes(HWDrawInfo *di, FRenderState &state);
     void DrawFloodPlanes(HWDrawInfo *di, FRenderState &state);
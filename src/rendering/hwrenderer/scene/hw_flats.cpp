@@ -191,20 +191,49 @@ void HWFlat::SetupLights(HWDrawInfo *di, FLightNode * node, FDynLightData &light
 //
 //==========================================================================
 
-void HWFlat::DrawSubsectors(HWDrawInfo *di, FRenderState &state)
+void HWFlat::DrawSubsectors(HWDrawInfo *di, FRenderState &state, int batchcount)
 {
-	if (di->Level->HasDynamicLights && screen->BuffersArePersistent() && !di->isFullbrightScene())
+	if (batchcount < 0)
 	{
-		SetupLights(di, section->lighthead, lightdata, sector->PortalGroup);
+		if (di->Level->HasDynamicLights && screen->BuffersArePersistent() && !di->isFullbrightScene())
+		{
+			SetupLights(di, section->lighthead, lightdata, sector->PortalGroup);
+		}
+		batchcount = section->vertexcount;
 	}
+	// else the draw list has already set up the lights and merged the following sections' indices into this one.
 	state.SetLightIndex(dynlightindex);
 
 
-	state.DrawIndexed(DT_Triangles, iboindex + section->vertexindex, section->vertexcount);
-	flatvertices += section->vertexcount;
+	state.DrawIndexed(DT_Triangles, iboindex + section->vertexindex, batchcount);
+	flatvertices += batchcount;
 	flatprimitives++;
 }
 
+//==========================================================================
+//
+// Flats that end up in DrawSubsectors can be merged by the draw list
+// if they are sections of the same sector plane, because each sector's
+// sections are stored back to back in the index buffer.
+//
+//==========================================================================
+
+bool HWFlat::IsBatchable() const
+{
+	return !(hacktype & (SSRF_PLANEHACK | SSRF_FLOODHACK)) && sector->special != GLSector_Skybox;
+}
+
+bool HWFlat::CanBatchWith(HWFlat *next, int batchcount)
+{
+	return next->sector == sector && next->ceiling == ceiling && next->iboindex == iboindex &&
+		next->section->vertexindex == section->vertexindex + batchcount &&
+		next->texture == texture && next->TextureFx == TextureFx &&
+		next->dynlightindex == -1 && dynlightindex == -1 &&
+		next->lightlevel == lightlevel && next->Colormap == Colormap && next->alpha == alpha &&
+		next->renderstyle == renderstyle && next->FlatColor == FlatColor && next->AddColor == AddColor &&
+		next->z == z && next->plane.Offs == plane.Offs && next->plane.Scale == plane.Scale && next->plane.Angle == plane.Angle;
+}
+
 
 //==========================================================================
 //
@@ -302,7 +331,7 @@ void HWFlat::DrawFloodPlanes(HWDrawInfo *di, FRenderState &state)
 //
 //
 //==========================================================================
-void HWFlat::DrawFlat(HWDrawInfo *di, FRenderState &state, bool translucent)
+void HWFlat::DrawFlat(HWDrawInfo *di, FRenderState &state, bool translucent, int batchcount)
 {
 #ifdef _DEBUG
 	if (sector->sectornum == gl_breaksec)
@@ -336,7 +365,7 @@ void HWFlat::DrawFlat(HWDrawInfo *di, FRenderState &state, bool translucent)
 		{
 			state.SetMaterial(texture, UF_Texture, 0, CLAMP_NONE, 0, -1);
 			SetPlaneTextureRotation(state, &plane, texture);
-			DrawSubsectors(di, state);
+			DrawSubsectors(di, state, batchcount);
 			state.EnableTextureMatrix(false);
 		}
 		else if (!hacktype)
@@ -355,7 +384,7 @@ void HWFlat::DrawFlat(HWDrawInfo *di, FRenderState &state, bool translucent)
 		{
 			state.AlphaFunc(Alpha_GEqual, 0.f);
 			state.EnableTexture(false);
-			DrawSubsectors(di, state);
+			DrawSubsectors(di, state, batchcount);
 			state.EnableTexture(true);
 		}
 		else
@@ -364,7 +393,7 @@ void HWFlat::DrawFlat(HWDrawInfo *di, FRenderState &state, bool translucent)
 			else state.AlphaFunc(Alpha_GEqual, 0.f);
 			state.SetMaterial(texture, UF_Texture, 0, CLAMP_NONE, 0, -1);
 			SetPlaneTextureRotation(state, &plane, texture);
-			DrawSubsectors(di, state);
+			DrawSubsectors(di, state, batchcount);
 			state.EnableTextureMatrix(false);
 		}
 		state.SetRenderStyle(DefaultRenderStyle());
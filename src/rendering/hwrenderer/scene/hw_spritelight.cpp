@@ -109,7 +109,6 @@ LightProbe* FindLightProbe(FLevelLocals* level, float x, float y, float z)
 
 void HWDrawInfo::GetDynSpriteLight(AActor *self, float x, float y, float z, FLightNode *node, int portalgroup, float *out)
 {
-	FDynamicLight *light;
 	float frac, lr, lg, lb;
 	float radius;
 	
@@ -123,10 +122,35 @@ void HWDrawInfo::GetDynSpriteLight(AActor *self, float x, float y, float z, FLig
 		out[2] = probe->Blue;
 	}
 
-	// Go through both light lists
-	while (node)
+	// The shadow map ray tests of several lights get done together.
+	struct FShadowedLight
+	{
+		DVector3 pos;
+		float r, g, b;
+	};
+	FShadowedLight shadowed[hwrenderer::LevelAABBTree::RayPacketSize];
+	int numshadowed = 0;
+
+	auto flushShadowed = [&]()
+	{
+		DVector3 lpos[hwrenderer::LevelAABBTree::RayPacketSize];
+		bool visible[hwrenderer::LevelAABBTree::RayPacketSize];
+		for (int i = 0; i < numshadowed; i++) lpos[i] = shadowed[i].pos;
+		screen->mShadowMap.ShadowTest(lpos, numshadowed, { x, y, z }, visible);
+		for (int i = 0; i < numshadowed; i++)
+		{
+			if (visible[i])
+			{
+				out[0] += shadowed[i].r;
+				out[1] += shadowed[i].g;
+				out[2] += shadowed[i].b;
+			}
+		}
+		numshadowed = 0;
+	};
+
+	auto addLight = [&](FDynamicLight *light)
 	{
-		light=node->lightsource;
 		if (light->ShouldLightActor(self))
 		{
 			float dist;
@@ -171,7 +195,7 @@ void HWDrawInfo::GetDynSpriteLight(AActor *self, float x, float y, float z, FLig
 					frac *= (float)smoothstep(light->pSpotOuterAngle->Cos(), light->pSpotInnerAngle->Cos(), cosDir);
 				}
 
-				if (frac > 0 && (!light->shadowmapped || (light->GetRadius() > 0 && screen->mShadowMap.ShadowTest(light->Pos, { x, y, z }))))
+				if (frac > 0 && (!light->shadowmapped || light->GetRadius() > 0))
 				{
 					lr = light->GetRed() / 255.0f;
 					lg = light->GetGreen() / 255.0f;
@@ -185,14 +209,28 @@ void HWDrawInfo::GetDynSpriteLight(AActor *self, float x, float y, float z, FLig
 						lb = (bright - lb) * -1;
 					}
 
-					out[0] += lr * frac;
-					out[1] += lg * frac;
-					out[2] += lb * frac;
+					if (light->shadowmapped)
+					{
+						shadowed[numshadowed++] = { light->Pos, lr * frac, lg * frac, lb * frac };
+						if (numshadowed == hwrenderer::LevelAABBTree::RayPacketSize) flushShadowed();
+					}
+					else
+					{
+						out[0] += lr * frac;
+						out[1] += lg * frac;
+						out[2] += lb * frac;
+					}
 				}
 			}
 		}
-		node = node->nextLight;
+	};
+
+	// Go through both light lists
+	for (; node; node = node->nextLight)
+	{
+		addLight(node->lightsource);
 	}
+	if (numshadowed > 0) flushShadowed();
 }
 
 void HWDrawInfo::GetDynSpriteLight(AActor *thing, particle_t *particle, float *out)
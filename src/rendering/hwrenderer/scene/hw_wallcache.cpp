@@ -0,0 +1,181 @@
+//
+//---------------------------------------------------------------------------
+//
+// Copyright(C) 2026 GZDoom Development Team
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//--------------------------------------------------------------------------
+//
+/*
+** hw_wallcache.cpp
+** Reuses the processed walls of segs that did not change
+**
+*/
+
+#include "c_cvars.h"
+#include "stats.h"
+#include "g_levellocals.h"
+#include "p_3dfloors.h"
+#include "texturemanager.h"
+#include "hw_cvars.h"
+#include "hwrenderer/scene/hw_drawinfo.h"
+#include "hw_wallcache.h"
+
+CVAR(Bool, gl_wallcache, true, 0)
+EXTERN_CVAR(Int, r_fakecontrast)
+
+FWallCache WallCache;
+thread_local FWallCache::Entry *WallCacheRecording;
+
+//==========================================================================
+//
+// Builds the hash of a seg's inputs
+//
+//==========================================================================
+
+class FWallCacheKey
+{
+	uint64_t key = 0xcbf29ce484222325ull;
+
+public:
+	void Add(uint64_t value)
+	{
+		key = (key ^ value) * 0x100000001b3ull;
+	}
+	void Add(double value)
+	{
+		uint64_t v;
+		memcpy(&v, &value, sizeof(v));
+		Add(v);
+	}
+	void Add(const void *ptr)
+	{
+		Add(uint64_t(uintptr_t(ptr)));
+	}
+	void AddSector(sector_t *sec)
+	{
+		Add(uint64_t(sec->changecount));
+		Add(uint64_t(sec->lightlevel));
+		Add(sec->floorplane.fD());
+		Add(sec->ceilingplane.fD());
+		Add(uint64_t(sec->Colormap.LightColor.d) | (uint64_t(sec->Colormap.FadeColor.d) << 32));
+		Add(uint64_t(sec->Colormap.Desaturation) | (uint64_t(sec->Colormap.BlendFactor) << 8) | (uint64_t(sec->Colormap.FogDensity) << 16));
+		// Missing textures get filled with the animated flats.
+		Add(TexMan.GetGameTexture(sec->GetTexture(sector_t::floor), true));
+		Add(TexMan.GetGameTexture(sec->GetTexture(sector_t::ceiling), true));
+		for (auto rover : sec->e->XFloor.ffloors)
+		{
+			Add(uint64_t(rover->flags) | (uint64_t(rover->alpha) << 32));
+			Add(uint64_t(rover->model->changecount) | (uint64_t(rover->model->lightlevel) << 32));
+			Add(rover->top.plane->fD());
+			Add(rover->bottom.plane->fD());
+			if (rover->master != nullptr) Add(TexMan.GetGameTexture(rover->master->sidedef[0]->GetTexture(side_t::mid), true));
+		}
+	}
+	void AddVertex(vertex_t *v)
+	{
+		if (v->dirty) v->RecalcVertexHeights();
+		Add(uint64_t(v->numheights));
+		for (int i = 0; i < v->numheights; i++) Add(double(v->heightlist[i]));
+	}
+	uint64_t Get() const
+	{
+		return key | 1;	// an empty entry's key is 0.
+	}
+};
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FWallCache::Clear()
+{
+	CacheLevel = nullptr;
+	Entries.Reset();
+}
+
+//==========================================================================
+//
+// Must be called before the BSP is traversed. The entries are never
+// reallocated while the worker thread is processing walls.
+//
+//==========================================================================
+
+void FWallCache::Prepare(FLevelLocals *Level)
+{
+	Hits = Misses = Uncached = 0;
+	if (Level != CacheLevel || Entries.Size() != Level->segs.Size())
+	{
+		Clear();
+		CacheLevel = Level;
+		Entries.Resize(Level->segs.Size());
+	}
+}
+
+//==========================================================================
+//
+// Returns the seg's entry and its current key, or null if the seg's
+// walls cannot be cached.
+//
+//==========================================================================
+
+FWallCache::Entry *FWallCache::Find(HWDrawInfo *di, seg_t *seg, sector_t *frontsector, sector_t *backsector, uint64_t &key)
+{
+	auto Level = di->Level;
+	if (!gl_wallcache || Level != CacheLevel || (seg->sidedef->Flags & WALLF_POLYOBJ) ||
+		frontsector != &Level->sectors[frontsector->sectornum] ||
+		(backsector != nullptr && backsector != &Level->sectors[backsector->sectornum]))
+	{
+		Uncached++;
+		return nullptr;
+	}
+
+	FWallCacheKey hash;
+	auto side = seg->sidedef;
+	auto line = seg->linedef;
+
+	hash.Add(uint64_t(di->isFullbrightScene()) | (uint64_t(gl_seamless) << 1) | (uint64_t(gl_mirrors) << 2) | (uint64_t(uint8_t(r_fakecontrast)) << 8) | (uint64_t(Level->i_compatflags) << 32));
+	hash.Add(uint64_t(Level->flags) | (uint64_t(uint32_t(Level->i_compatflags2)) << 32));
+	hash.Add(uint64_t(Level->flags2) | (uint64_t(Level->flags3) << 32));
+	hash.Add(uint64_t(uint8_t(Level->WallHorizLight)) | (uint64_t(uint8_t(Level->WallVertLight)) << 8));
+	hash.Add(uint64_t(line->flags) | (uint64_t(line->special) << 32));
+	hash.Add(line->alpha);
+	hash.Add(uint64_t(side->changecount) | (uint64_t(side->Flags) << 32));
+	hash.Add(uint64_t(uint16_t(side->Light)));
+	for (int i = 0; i < 3; i++)
+	{
+		hash.Add(TexMan.GetGameTexture(side->GetTexture(i), true));
+	}
+	hash.AddSector(frontsector);
+	if (backsector != nullptr) hash.AddSector(backsector);
+	if (gl_seamless)
+	{
+		hash.AddVertex(line->v1);
+		hash.AddVertex(line->v2);
+	}
+
+	key = hash.Get();
+	return &Entries[seg->Index()];
+}
+
+ADD_STAT(wallcache)
+{
+	FString out;
+	out.Format("%d cached, %d processed, %d not cacheable", WallCache.Hits.load(), WallCache.Misses.load(), WallCache.Uncached.load());
+	return out;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include "tarray.h"
+#include "hw_drawstructs.h"
+
+struct FLevelLocals;
+struct HWDrawInfo;
+
+//==========================================================================
+//
+// Keeps the walls HWWall::Process generated for each seg along with a hash
+// of everything that went into them: both sectors' planes, textures, light
+// and change counters, the sidedef and line properties, the 3D floors and
+// vertex height lists. As long as the hash doesn't change the texture
+// coordinate calculations and 3D floor splitting can be skipped and the
+// stored walls just get submitted again.
+//
+// Segs that produce portals, skies or missing texture fills are processed
+// normally every frame, as are polyobjects and anything seen through a
+// heightsec, whose sectors get faked per view.
+//
+//==========================================================================
+
+class FWallCache
+{
+public:
+	struct CachedWall
+	{
+		HWWall wall;
+		bool translucent;
+	};
+
+	struct Entry
+	{
+		uint64_t key = 0;
+		bool valid = false;
+		TArray<CachedWall> walls;
+	};
+
+	void Clear();
+	void Prepare(FLevelLocals *Level);
+	Entry *Find(HWDrawInfo *di, seg_t *seg, sector_t *frontsector, sector_t *backsector, uint64_t &key);
+
+	std::atomic<int> Hits = {}, Misses = {}, Uncached = {};
+
+private:
+	FLevelLocals *CacheLevel = nullptr;
+	TArray<Entry> Entries;	// indexed by seg
+};
+
+extern FWallCache WallCache;
+extern thread_local FWallCache::Entry *WallCacheRecording;
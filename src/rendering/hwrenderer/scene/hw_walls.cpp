@@ -40,6 +40,7 @@
 #include "hwrenderer/scene/hw_drawinfo.h"
 #include "hwrenderer/scene/hw_drawstructs.h"
 #include "hwrenderer/scene/hw_portal.h"
+#include "hwrenderer/scene/hw_wallcache.h"
 #include "hw_lightbuffer.h"
 #include "hw_renderstate.h"
 #include "hw_skydome.h"
@@ -495,6 +496,8 @@ const char HWWall::passflag[] = {
 //==========================================================================
 void HWWall::PutWall(HWDrawInfo *di, bool translucent)
 {
+	if (WallCacheRecording) WallCacheRecording->walls.Push({ *this, translucent });
+
 	if (texture && texture->GetTranslucency() && passflag[type] == 2)
 	{
 		translucent = true;
@@ -567,6 +570,7 @@ void HWWall::PutPortal(HWDrawInfo *di, int ptype, int plane)
 {
 	HWPortal * portal = nullptr;
 
+	if (WallCacheRecording) WallCacheRecording->valid = false;
 	MakeVertices(di, false);
 	switch (ptype)
 	{
@@ -2015,10 +2019,50 @@ inline int CalcRelLight(int lightlevel, int orglightlevel, int rel)
 
 //==========================================================================
 //
-// 
+// Resubmits the walls from the cache if nothing about the seg changed
+// since they were generated, otherwise processes and records them.
 //
 //==========================================================================
+
 void HWWall::Process(HWDrawInfo *di, seg_t *seg, sector_t * frontsector, sector_t * backsector)
+{
+	uint64_t key;
+	auto entry = WallCache.Find(di, seg, frontsector, backsector, key);
+	if (entry != nullptr)
+	{
+		if (entry->key == key)
+		{
+			if (entry->valid)
+			{
+				WallCache.Hits++;
+				for (auto &cached : entry->walls)
+				{
+					HWWall wall = cached.wall;
+					wall.PutWall(di, cached.translucent);
+				}
+				return;
+			}
+			WallCache.Uncached++;	// produced portals or missing texture fills last time.
+		}
+		else
+		{
+			WallCache.Misses++;
+			entry->key = key;
+			entry->valid = true;
+			entry->walls.Clear();
+			WallCacheRecording = entry;
+		}
+	}
+	ProcessSeg(di, seg, frontsector, backsector);
+	WallCacheRecording = nullptr;
+}
+
+//==========================================================================
+//
+// 
+//
+//==========================================================================
+void HWWall::ProcessSeg(HWDrawInfo *di, seg_t *seg, sector_t * frontsector, sector_t * backsector)
 {
 	vertex_t * v1, *v2;
 	float fch1;
@@ -2262,6 +2306,7 @@ void HWWall::Process(HWDrawInfo *di, seg_t *seg, sector_t * frontsector, sector_
 						// skip processing if the back is a malformed subsector
 						if (seg->PartnerSeg != NULL && !(seg->PartnerSeg->Subsector->hacked & 4))
 						{
+							if (WallCacheRecording) WallCacheRecording->valid = false;
 							di->AddUpperMissingTexture(seg->sidedef, sub, bch1a);
 						}
 					}
@@ -2365,6 +2410,7 @@ void HWWall::Process(HWDrawInfo *di, seg_t *seg, sector_t * frontsector, sector_
 					// skip processing if the back is a malformed subsector
 					if (seg->PartnerSeg != NULL && !(seg->PartnerSeg->Subsector->hacked & 4))
 					{
+						if (WallCacheRecording) WallCacheRecording->valid = false;
 						di->AddLowerMissingTexture(seg->sidedef, sub, bfh1);
 					}
 				}
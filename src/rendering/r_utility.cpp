@@ -66,6 +66,7 @@
 #include "i_system.h"
 #include "v_draw.h"
 #include "i_interface.h"
+#include "a_dynlight.h"
 
 // EXTERNAL DATA DECLARATIONS ----------------------------------------------
 
@@ -758,6 +759,9 @@ void R_SetupFrame (FRenderViewpoint &viewpoint, FViewWindow &viewwindow, AActor
 	}
 	viewpoint.ViewLevel = actor->Level;
 
+	// Lights changed outside of the thinker loop may still need to be linked.
+	FDynamicLight::LinkPendingLights();
+
 	player_t *player = actor->player;
 	unsigned int newblend;
 	InterpolationViewer *iview;
@@ -1248,6 +1248,19 @@ DEFINE_ACTION_FUNCTION_NATIVE(_Sector, SetXOffset, SetXOffset)
 	 return 0;
  }
 
+ static void SetSideLight(side_t *self, int light)
+ {
+	 self->SetLight(int16_t(light));
+ }
+
+ DEFINE_ACTION_FUNCTION_NATIVE(_Side, SetLight, SetSideLight)
+ {
+	 PARAM_SELF_STRUCT_PROLOGUE(side_t);
+	 PARAM_INT(light);
+	 SetSideLight(self, light);
+	 return 0;
+ }
+
  static void SetTextureXOffset(side_t *self, int which, double ofs)
  {
 	 self->SetTextureXOffset(which, ofs);